@@ -0,0 +1,177 @@
+// ApiClient.cpp
+#include "ApiClient.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <algorithm>
+
+// Default backend; the live WebSocket is on the same host
+static const char* const DEFAULT_BASE_URL = "http://localhost:8080";
+
+ApiClient* ApiClient::instance()
+{
+    // Owned by the application so it goes away with the GUI thread
+    static ApiClient* client = new ApiClient(QCoreApplication::instance());
+    return client;
+}
+
+ApiClient::ApiClient(QObject* parent)
+    : QObject(parent),
+    m_manager(new QNetworkAccessManager(this)),
+    m_baseUrl(QString::fromLatin1(DEFAULT_BASE_URL))
+{
+    // Open the connection now, so the first dialog does not wait for it
+    m_manager->connectToHost(m_baseUrl.host(), m_baseUrl.port(80));
+}
+
+void ApiClient::setBaseUrl(const QUrl& url)
+{
+    m_baseUrl = url;
+    m_manager->connectToHost(m_baseUrl.host(), m_baseUrl.port(80));
+}
+
+QNetworkRequest ApiClient::request(const QString& endpoint) const
+{
+    QUrl url = m_baseUrl;
+    url.setPath(endpoint);
+
+    QNetworkRequest request(url);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    // HTTP/2 over TLS is negotiated anyway; plain http needs h2c allowed
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setAttribute(QNetworkRequest::Http2CleartextAllowedAttribute, true);
+    return request;
+}
+
+QNetworkReply* ApiClient::send(const QNetworkRequest& request, const QByteArray& verb, const QByteArray& body)
+{
+    QNetworkReply* reply = m_manager->sendCustomRequest(request, verb, body);
+
+    const QString endpoint = request.url().path();
+    QElapsedTimer timer;
+    timer.start();
+
+    // Headers in: the server has done its work, the rest is transfer
+    connect(reply, &QNetworkReply::metaDataChanged, this, [reply, timer]() {
+        if (!reply->property("firstByteMs").isValid()) {
+            reply->setProperty("firstByteMs", timer.elapsed());
+        }
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, endpoint, timer]() {
+        const qint64 totalMs = timer.elapsed();
+        const qint64 firstByteMs = reply->property("firstByteMs").isValid()
+                                       ? reply->property("firstByteMs").toLongLong() : totalMs;
+        // An abort is the caller's decision, not the endpoint's failure
+        const bool failed = reply->error() != QNetworkReply::NoError
+                            && reply->error() != QNetworkReply::OperationCanceledError;
+        recordFinished(endpoint, firstByteMs, totalMs, failed);
+    });
+    return reply;
+}
+
+void ApiClient::fetch(const QNetworkRequest& request, const QByteArray& verb, const QByteArray& body,
+                      QObject* context, const Callback& callback)
+{
+    // Only requests without side effects can be shared
+    const bool shareable = verb == "GET";
+    QString key;
+    if (shareable) {
+        key = QString::fromLatin1(verb) + ' ' + request.url().toString() + '\n'
+              + QString::fromUtf8(request.rawHeader("Accept")) + '\n' + QString::fromUtf8(body);
+
+        auto pending = m_pending.find(key);
+        if (pending != m_pending.end()) {
+            pending->waiters.append({context, callback});
+            EndpointStats& stats = m_stats[request.url().path()];
+            stats.endpoint = request.url().path();
+            ++stats.coalesced;
+            return;
+        }
+    }
+
+    QNetworkReply* reply = send(request, verb, body);
+    if (!shareable) {
+        QPointer<QObject> guard(context);
+        connect(reply, &QNetworkReply::finished, this, [reply, guard, callback]() {
+            reply->deleteLater();
+            if (!guard)
+                return;
+
+            Response response;
+            response.error = reply->error();
+            response.errorString = reply->errorString();
+            response.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            response.body = reply->readAll();
+            callback(response);
+        });
+        return;
+    }
+
+    Pending& pending = m_pending[key];
+    pending.reply = reply;
+    pending.waiters.append({context, callback});
+    connect(reply, &QNetworkReply::finished, this, [this, key]() { finishPending(key); });
+}
+
+void ApiClient::finishPending(const QString& key)
+{
+    const Pending pending = m_pending.take(key);
+    QNetworkReply* reply = pending.reply;
+    reply->deleteLater();
+
+    Response response;
+    response.error = reply->error();
+    response.errorString = reply->errorString();
+    response.status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    response.body = reply->readAll();
+
+    for (const Waiter& waiter : pending.waiters) {
+        if (waiter.context) {
+            waiter.callback(response);
+        }
+    }
+}
+
+void ApiClient::recordFinished(const QString& endpoint, qint64 firstByteMs, qint64 totalMs, bool failed)
+{
+    EndpointStats& stats = m_stats[endpoint];
+    stats.endpoint = endpoint;
+    if (failed) {
+        ++stats.failures;
+        return;
+    }
+
+    // Running means over successful requests
+    ++stats.requests;
+    stats.meanFirstByteMs += (firstByteMs - stats.meanFirstByteMs) / stats.requests;
+    stats.meanTotalMs += (totalMs - stats.meanTotalMs) / stats.requests;
+    stats.maxTotalMs = qMax(stats.maxTotalMs, totalMs);
+}
+
+QVector<ApiClient::EndpointStats> ApiClient::stats() const
+{
+    QVector<EndpointStats> result;
+    result.reserve(m_stats.size());
+    for (const EndpointStats& stats : m_stats) {
+        result.append(stats);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const EndpointStats& a, const EndpointStats& b) { return a.endpoint < b.endpoint; });
+    return result;
+}
+
+QString ApiClient::statsSummary() const
+{
+    QStringList lines;
+    for (const EndpointStats& stats : this->stats()) {
+        lines << QString("%1: %2 requests, first byte %3 ms, total %4 ms (max %5 ms), %6 failed, %7 shared")
+                     .arg(stats.endpoint)
+                     .arg(stats.requests)
+                     .arg(stats.meanFirstByteMs, 0, 'f', 0)
+                     .arg(stats.meanTotalMs, 0, 'f', 0)
+                     .arg(stats.maxTotalMs)
+                     .arg(stats.failures)
+                     .arg(stats.coalesced);
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,95 @@
+// ApiClient.h
+#ifndef APICLIENT_H
+#define APICLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QPointer>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+#include <functional>
+
+// The one HTTP client of the application, for every call to the backend's
+// REST endpoints. A single QNetworkAccessManager means connections are kept
+// alive and reused across dialogs, HTTP/2 is negotiated where the server
+// offers it (one multiplexed connection instead of several), and gzip or
+// deflate replies are decoded transparently; callers must therefore not set
+// Accept-Encoding themselves.
+//
+// Two ways to call:
+//   send()   returns the reply itself, for streaming or aborting; the caller
+//            owns it
+//   fetch()  buffers the reply and hands it to a callback. Identical GETs in
+//            flight share one request; callbacks whose context is gone are
+//            skipped.
+// Both record per-endpoint latency, see stats().
+class ApiClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Response {
+        QNetworkReply::NetworkError error = QNetworkReply::NoError;
+        QString errorString;
+        int status = 0;   // HTTP status code, 0 if none was received
+        QByteArray body;
+    };
+
+    using Callback = std::function<void(const Response&)>;
+
+    struct EndpointStats {
+        QString endpoint;
+        int requests = 0;
+        int failures = 0;
+        // Served to a second caller from a request already in flight
+        int coalesced = 0;
+        double meanFirstByteMs = 0;   // until the response headers
+        double meanTotalMs = 0;
+        qint64 maxTotalMs = 0;
+    };
+
+    static ApiClient* instance();
+
+    void setBaseUrl(const QUrl& url);
+    QUrl baseUrl() const { return m_baseUrl; }
+
+    // A JSON request to an endpoint of the backend, e.g. "/recordData"
+    QNetworkRequest request(const QString& endpoint) const;
+
+    QNetworkReply* send(const QNetworkRequest& request, const QByteArray& verb, const QByteArray& body = QByteArray());
+    void fetch(const QNetworkRequest& request, const QByteArray& verb, const QByteArray& body,
+               QObject* context, const Callback& callback);
+
+    QVector<EndpointStats> stats() const;
+    // One line per endpoint, for tooltips and logs
+    QString statsSummary() const;
+
+private:
+    explicit ApiClient(QObject* parent = nullptr);
+
+    struct Waiter {
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    struct Pending {
+        QNetworkReply* reply = nullptr;
+        QVector<Waiter> waiters;
+    };
+
+    void recordFinished(const QString& endpoint, qint64 firstByteMs, qint64 totalMs, bool failed);
+    void finishPending(const QString& key);
+
+    QNetworkAccessManager* m_manager;
+    QUrl m_baseUrl;
+    // Buffered GETs in flight, by verb, URL and body
+    QHash<QString, Pending> m_pending;
+    QHash<QString, EndpointStats> m_stats;
+};
+
+#endif // APICLIENT_H
@@ -0,0 +1,157 @@
+// BucketColumns.cpp
+#include "BucketColumns.h"
+#include "RecordStreamParser.h"
+#include "SampleStore.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const char* const StatisticKeys[BucketColumns::StatisticCount] = {"min", "max", "avg"};
+
+qint64 BucketColumns::memoryUsage() const
+{
+    qint64 bytes = timestamps.capacity() * qint64(sizeof(qint64)) + counts.capacity() * qint64(sizeof(int));
+    for (const auto& statistic : values) {
+        for (const QVector<float>& column : statistic) {
+            bytes += column.capacity() * qint64(sizeof(float));
+        }
+    }
+    return bytes;
+}
+
+float BucketColumns::total(Statistic statistic, ChannelSchema::Quantity quantity, int row) const
+{
+    const int first = ChannelSchema::firstChannel(quantity);
+    const int count = ChannelSchema::channelCount(quantity);
+
+    float sum = 0;
+    for (int channel = first; channel < first + count; ++channel) {
+        sum += values[statistic][channel][row];
+    }
+    if (ChannelSchema::Quantities[quantity].total == ChannelSchema::Average)
+        return sum / count;
+    return sum;
+}
+
+BucketColumns BucketColumns::fromNdjson(const QByteArray& body, qint64 fromMs, qint64 toMs)
+{
+    BucketColumns buckets;
+
+    qsizetype start = 0;
+    while (start < body.size()) {
+        qsizetype end = body.indexOf('\n', start);
+        if (end < 0) {
+            end = body.size();
+        }
+        const QByteArray line = body.mid(start, end - start).trimmed();
+        start = end + 1;
+        if (line.isEmpty())
+            continue;
+
+        const QJsonObject bucket = QJsonDocument::fromJson(line).object();
+        qint64 timestampMs = 0;
+        if (bucket.isEmpty() || !RecordStreamParser::decodeTimestamp(bucket.value(QLatin1String("timestamp")), timestampMs)) {
+            ++buckets.malformed;
+            continue;
+        }
+        // The server's bounds are inclusive and in whole seconds
+        if (timestampMs < fromMs || timestampMs >= toMs)
+            continue;
+
+        buckets.timestamps.append(timestampMs);
+        buckets.counts.append(bucket.value(QLatin1String("count")).toInt());
+        for (int statistic = 0; statistic < StatisticCount; ++statistic) {
+            const QJsonObject channels = bucket.value(QLatin1String(StatisticKeys[statistic])).toObject();
+            for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+                buckets.values[statistic][channel].append(
+                    channels.value(QLatin1String(ChannelSchema::Channels[channel].key)).toDouble());
+            }
+        }
+    }
+    return buckets;
+}
+
+// Folds samples, oldest first, into buckets of a fixed length
+class BucketBuilder
+{
+public:
+    BucketBuilder(BucketColumns& buckets, qint64 bucketMs) : m_buckets(buckets), m_bucketMs(bucketMs) {}
+
+    void add(qint64 timestampMs, const float* values)
+    {
+        const qint64 start = timestampMs - timestampMs % m_bucketMs;
+        if (start != m_start) {
+            close();
+            m_start = start;
+        }
+
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            const float value = values[channel];
+            if (m_count == 0) {
+                m_minimum[channel] = m_maximum[channel] = value;
+                m_sum[channel] = value;
+            } else {
+                m_minimum[channel] = qMin(m_minimum[channel], value);
+                m_maximum[channel] = qMax(m_maximum[channel], value);
+                m_sum[channel] += value;
+            }
+        }
+        ++m_count;
+    }
+
+    // Appends the bucket being filled, if any
+    void close()
+    {
+        if (m_count == 0)
+            return;
+
+        m_buckets.timestamps.append(m_start);
+        m_buckets.counts.append(m_count);
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            m_buckets.values[BucketColumns::Minimum][channel].append(m_minimum[channel]);
+            m_buckets.values[BucketColumns::Maximum][channel].append(m_maximum[channel]);
+            m_buckets.values[BucketColumns::Average][channel].append(float(m_sum[channel] / m_count));
+        }
+        m_count = 0;
+    }
+
+private:
+    BucketColumns& m_buckets;
+    qint64 m_bucketMs;
+    qint64 m_start = -1;
+    int m_count = 0;
+    float m_minimum[ChannelSchema::ChannelCount];
+    float m_maximum[ChannelSchema::ChannelCount];
+    double m_sum[ChannelSchema::ChannelCount];
+};
+
+BucketColumns BucketColumns::fromStore(const QString& topic, qint64 bucketMs, qint64 fromMs, qint64 toMs)
+{
+    BucketColumns buckets;
+    BucketBuilder builder(buckets, bucketMs);
+
+    const SampleStore store;
+    store.query(topic, fromMs, toMs - 1, [&builder](const PowerSample& sample) {
+        builder.add(sample.timestampMs, sample.values);
+    });
+
+    builder.close();
+    return buckets;
+}
+
+BucketColumns BucketColumns::fromColumns(const RecordColumns& records, qint64 bucketMs, qint64 fromMs, qint64 toMs)
+{
+    BucketColumns buckets;
+    BucketBuilder builder(buckets, bucketMs);
+
+    const RecordColumns rows = records.between(fromMs, toMs);
+    float values[ChannelSchema::ChannelCount];
+    for (int row = 0; row < rows.size(); ++row) {
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            values[channel] = rows.channels[channel][row];
+        }
+        builder.add(rows.timestamps[row], values);
+    }
+
+    builder.close();
+    return buckets;
+}
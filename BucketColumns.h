@@ -0,0 +1,44 @@
+// BucketColumns.h
+#ifndef BUCKETCOLUMNS_H
+#define BUCKETCOLUMNS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "ChannelSchema.h"
+#include "RecordColumns.h"
+
+// Aggregated history in typed columns: one row per time bucket, with the
+// number of samples and the minimum, maximum and average of every channel.
+// Buckets have a fixed length and start at multiples of it since the epoch.
+// The backend's /recordBuckets answers in NDJSON like /recordData, one line
+// per bucket that holds samples, oldest first:
+//   {"timestamp": <bucket start>, "count": n,
+//    "min": {"v1":..., ...}, "max": {...}, "avg": {...}}
+struct BucketColumns
+{
+    enum Statistic { Minimum, Maximum, Average, StatisticCount };
+
+    QVector<qint64> timestamps;
+    QVector<int> counts;
+    QVector<float> values[StatisticCount][ChannelSchema::ChannelCount];
+    // Buckets that could not be decoded
+    int malformed = 0;
+
+    int size() const { return timestamps.size(); }
+    bool isEmpty() const { return timestamps.isEmpty(); }
+    qint64 memoryUsage() const;
+
+    // A quantity's total for one bucket: for the average exact, for minimum
+    // and maximum an envelope, since the phases need not peak together
+    float total(Statistic statistic, ChannelSchema::Quantity quantity, int row) const;
+
+    // Buckets starting in [fromMs, toMs). Safe to run on any thread.
+    static BucketColumns fromNdjson(const QByteArray& body, qint64 fromMs, qint64 toMs);
+    // The same buckets, computed from the local store or from records in
+    // memory, in time order
+    static BucketColumns fromStore(const QString& topic, qint64 bucketMs, qint64 fromMs, qint64 toMs);
+    static BucketColumns fromColumns(const RecordColumns& records, qint64 bucketMs, qint64 fromMs, qint64 toMs);
+};
+
+#endif // BUCKETCOLUMNS_H
@@ -0,0 +1,190 @@
+// ChannelSchema.h
+#ifndef CHANNELSCHEMA_H
+#define CHANNELSCHEMA_H
+
+#include <QString>
+#include <QStringView>
+
+// Single description of every measured channel. Decoders, gauges, chart
+// series, history table columns and CSV headers are all generated from these
+// tables; nothing else spells out "v1".."p3". Adding a channel (frequency,
+// power factor, ...) means adding rows here and nothing on the hot path.
+namespace ChannelSchema {
+
+enum Quantity { Voltage, Current, Power, QuantityCount };
+
+// How the "Total" column of a quantity is derived from its channels
+enum TotalKind { Sum, Average };
+
+struct QuantityInfo {
+    const char* name;         // "Voltage", series selector and table headers
+    const char* chartTitle;   // "Voltage"
+    const char* gaugeTitle;   // "VOLTAGE"
+    const char* unit;         // "V"
+    double gaugeMin;
+    double gaugeMax;
+    unsigned gaugeColor;      // 0xRRGGBB
+    TotalKind total;
+};
+
+constexpr QuantityInfo Quantities[QuantityCount] = {
+    {"Voltage", "Voltage",     "VOLTAGE", "V", 0, 500,  0x00FFAA, Average},
+    {"Current", "Current",     "CURRENT", "A", 0, 100,  0xFF6464, Sum},
+    {"Power",   "Power Usage", "POWER",   "W", 0, 5000, 0x6496FF, Sum},
+};
+
+// Channel order is also the order of the values in PowerSample, in the
+// ring-buffer columns and on the binary wire format
+enum Channel {
+    V1, V2, V3,
+    C1, C2, C3,
+    P1, P2, P3,
+    ChannelCount
+};
+
+struct ChannelInfo {
+    const char* key;      // JSON key
+    const char* label;    // column / series label
+    Quantity quantity;
+    int phase;            // 0-based
+};
+
+constexpr ChannelInfo Channels[ChannelCount] = {
+    {"v1", "V1", Voltage, 0}, {"v2", "V2", Voltage, 1}, {"v3", "V3", Voltage, 2},
+    {"c1", "C1", Current, 0}, {"c2", "C2", Current, 1}, {"c3", "C3", Current, 2},
+    {"p1", "P1", Power,   0}, {"p2", "P2", Power,   1}, {"p3", "P3", Power,   2},
+};
+
+constexpr int PhaseCount = 3;
+
+// Charts of a cluster, in the order of the series selector
+constexpr Quantity ChartQuantities[] = {Power, Voltage, Current};
+constexpr int ChartCount = sizeof(ChartQuantities) / sizeof(ChartQuantities[0]);
+
+// Quantity groups of history tables and exports, left to right; each group
+// is a "Total" column followed by the quantity's channels
+constexpr Quantity TableQuantities[] = {Power, Current, Voltage};
+
+// Channels of a quantity are contiguous; these give the range
+constexpr int firstChannel(Quantity quantity)
+{
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        if (Channels[channel].quantity == quantity)
+            return channel;
+    }
+    return ChannelCount;
+}
+
+constexpr int channelCount(Quantity quantity)
+{
+    int count = 0;
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        if (Channels[channel].quantity == quantity)
+            ++count;
+    }
+    return count;
+}
+
+// Channel shown by a chart's aggregate series (the last phase, as before)
+constexpr int aggregateChannel(Quantity quantity)
+{
+    return firstChannel(quantity) + channelCount(quantity) - 1;
+}
+
+static_assert(firstChannel(Voltage) == V1 && firstChannel(Current) == C1 && firstChannel(Power) == P1,
+              "Channels must be grouped by quantity");
+
+// Value of a quantity's "Total" column: the sum or the average of its channels
+template <typename Value>
+inline double quantityTotal(Quantity quantity, const Value* values)
+{
+    const int first = firstChannel(quantity);
+    const int count = channelCount(quantity);
+
+    double total = 0;
+    for (int channel = first; channel < first + count; ++channel) {
+        total += values[channel];
+    }
+    if (Quantities[quantity].total == Average) {
+        total /= count;
+    }
+    return total;
+}
+
+// Keys are found through a perfect hash of their length and first and last
+// characters. The table is built from Channels at compile time, so a new
+// channel only needs its row above; the static_assert catches collisions.
+constexpr int KeyHashSize = 64;
+
+constexpr int keyHash(unsigned length, unsigned first, unsigned last)
+{
+    return int((first * 7 + last * 3 + length) % KeyHashSize);
+}
+
+struct KeyIndex {
+    int slots[KeyHashSize];
+    bool perfect;
+};
+
+constexpr KeyIndex makeKeyIndex()
+{
+    KeyIndex index{};
+    for (int slot = 0; slot < KeyHashSize; ++slot) {
+        index.slots[slot] = -1;
+    }
+    index.perfect = true;
+
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        const char* key = Channels[channel].key;
+        unsigned length = 0;
+        while (key[length] != '\0') {
+            ++length;
+        }
+
+        int& slot = index.slots[keyHash(length, (unsigned char)key[0], (unsigned char)key[length - 1])];
+        if (slot >= 0) {
+            index.perfect = false;
+        }
+        slot = channel;
+    }
+    return index;
+}
+
+constexpr KeyIndex KeyIndexTable = makeKeyIndex();
+static_assert(KeyIndexTable.perfect, "Channel keys collide in keyHash(); adjust its factors");
+
+// Resolves a JSON or record archive key to its channel, or -1: one hash and
+// one comparison to reject unknown keys. Binary frames are positional and
+// need no lookup at all.
+inline int channelForKey(QStringView key)
+{
+    if (key.isEmpty())
+        return -1;
+
+    const int channel = KeyIndexTable.slots[keyHash(unsigned(key.size()), key.front().unicode(),
+                                                    key.back().unicode())];
+    if (channel < 0 || key != QLatin1String(Channels[channel].key))
+        return -1;
+    return channel;
+}
+
+inline QString columnHeader(int channel)
+{
+    return QString::fromLatin1(Channels[channel].label);
+}
+
+// "Power (W)"
+inline QString axisTitle(Quantity quantity)
+{
+    return QString("%1 (%2)").arg(QString::fromLatin1(Quantities[quantity].name),
+                                  QString::fromLatin1(Quantities[quantity].unit));
+}
+
+inline QString totalHeader(Quantity quantity)
+{
+    return QString("Total %1").arg(QString::fromLatin1(Quantities[quantity].name));
+}
+
+} // namespace ChannelSchema
+
+#endif // CHANNELSCHEMA_H
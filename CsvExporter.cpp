@@ -0,0 +1,288 @@
+// CsvExporter.cpp
+#include "CsvExporter.h"
+#include "SampleStore.h"
+#include <QDateTime>
+#include <QFile>
+#include <QTimeZone>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+// Buffered output plus the cheap formatting of one row's fields
+class CsvExporter::Writer
+{
+public:
+    static const int BUFFER_SIZE = 1024 * 1024;
+    // Longest row: timestamp plus 13 fixed-point fields with separators
+    static const int MAX_ROW_SIZE = 1024;
+
+    explicit Writer(const QString& fileName)
+        : m_file(fileName)
+    {
+        m_buffer.resize(BUFFER_SIZE);
+    }
+
+    bool open()
+    {
+        // Text mode, for the platform's line endings as before
+        return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+    }
+
+    QString errorString() const { return m_file.errorString(); }
+
+    // Leaves nothing behind after a cancelled or failed export
+    void discard()
+    {
+        m_file.close();
+        m_file.remove();
+    }
+
+    bool close()
+    {
+        flush();
+        m_file.close();
+        return !m_failed;
+    }
+
+    bool failed() const { return m_failed; }
+
+    void writeHeader(const QStringList& headers)
+    {
+        const QByteArray line = headers.join(",").toUtf8() + "\n";
+        reserve(line.size());
+        std::memcpy(m_buffer.data() + m_used, line.constData(), line.size());
+        m_used += line.size();
+    }
+
+    // Makes room for one row; returns false once the file can't be written
+    bool beginRow()
+    {
+        if (BUFFER_SIZE - m_used < MAX_ROW_SIZE) {
+            flush();
+        }
+        return !m_failed;
+    }
+
+    void writeTimestamp(qint64 timestampMs)
+    {
+        // Same text as QDateTime::toString(Qt::ISODate) in local time; the
+        // zone offset is only looked up again when a transition is crossed
+        if (timestampMs < m_offsetValidFromMs || timestampMs >= m_offsetValidToMs) {
+            updateOffset(timestampMs);
+        }
+
+        const qint64 localSeconds = floorDiv(timestampMs, 1000) + m_offsetSeconds;
+        const qint64 days = floorDiv(localSeconds, 86400);
+        const int secondOfDay = int(localSeconds - days * 86400);
+
+        int year, month, day;
+        civilFromDays(days, year, month, day);
+
+        char* out = m_buffer.data() + m_used;
+        out = std::to_chars(out, out + 8, year).ptr;
+        *out++ = '-';
+        out = twoDigits(out, month);
+        *out++ = '-';
+        out = twoDigits(out, day);
+        *out++ = 'T';
+        out = twoDigits(out, secondOfDay / 3600);
+        *out++ = ':';
+        out = twoDigits(out, secondOfDay / 60 % 60);
+        *out++ = ':';
+        out = twoDigits(out, secondOfDay % 60);
+        m_used = out - m_buffer.data();
+    }
+
+    void writeValue(float value)
+    {
+        char* out = m_buffer.data() + m_used;
+        *out++ = ',';
+        // Formatted as a double, exactly like QString::number(value, 'f', 2)
+        out = std::to_chars(out, m_buffer.data() + BUFFER_SIZE, double(value), std::chars_format::fixed, 2).ptr;
+        m_used = out - m_buffer.data();
+    }
+
+    void endRow()
+    {
+        m_buffer[m_used++] = '\n';
+    }
+
+private:
+    void flush()
+    {
+        if (m_used > 0 && m_file.write(m_buffer.constData(), m_used) != m_used) {
+            m_failed = true;
+        }
+        m_used = 0;
+    }
+
+    void reserve(int bytes)
+    {
+        if (BUFFER_SIZE - m_used < bytes) {
+            flush();
+        }
+    }
+
+    void updateOffset(qint64 timestampMs)
+    {
+        const QDateTime time = QDateTime::fromMSecsSinceEpoch(timestampMs);
+        m_offsetSeconds = time.offsetFromUtc();
+
+        const QTimeZone zone = QTimeZone::systemTimeZone();
+        const QTimeZone::OffsetData previous = zone.previousTransition(time.addMSecs(1));
+        const QTimeZone::OffsetData next = zone.nextTransition(time);
+        m_offsetValidFromMs = previous.atUtc.isValid() ? previous.atUtc.toMSecsSinceEpoch()
+                                                       : std::numeric_limits<qint64>::min();
+        m_offsetValidToMs = next.atUtc.isValid() ? next.atUtc.toMSecsSinceEpoch()
+                                                 : std::numeric_limits<qint64>::max();
+
+        // Zones that can't list their transitions change offset on quarter
+        // hours at the finest, so the offset is reused for one quarter hour
+        if (!zone.hasTransitions()) {
+            static const qint64 QUARTER_HOUR_MS = 15 * 60 * 1000;
+            m_offsetValidFromMs = floorDiv(timestampMs, QUARTER_HOUR_MS) * QUARTER_HOUR_MS;
+            m_offsetValidToMs = m_offsetValidFromMs + QUARTER_HOUR_MS;
+        }
+    }
+
+    static qint64 floorDiv(qint64 value, qint64 divisor)
+    {
+        const qint64 quotient = value / divisor;
+        return (value % divisor < 0) ? quotient - 1 : quotient;
+    }
+
+    // Days since 1970-01-01 to a proleptic Gregorian date (H. Hinnant's algorithm)
+    static void civilFromDays(qint64 days, int& year, int& month, int& day)
+    {
+        days += 719468;
+        const qint64 era = floorDiv(days, 146097);
+        const qint64 dayOfEra = days - era * 146097;
+        const qint64 yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const qint64 dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const qint64 monthIndex = (5 * dayOfYear + 2) / 153;
+        day = int(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+        month = int(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+        year = int(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+    }
+
+    static char* twoDigits(char* out, int value)
+    {
+        *out++ = char('0' + value / 10);
+        *out++ = char('0' + value % 10);
+        return out;
+    }
+
+    QFile m_file;
+    QByteArray m_buffer;
+    int m_used = 0;
+    bool m_failed = false;
+
+    int m_offsetSeconds = 0;
+    qint64 m_offsetValidFromMs = 0;
+    qint64 m_offsetValidToMs = 0;
+};
+
+void CsvExporter::writeRows(Writer& writer, const RecordColumns& records, int first, int last)
+{
+    const int columnCount = RecordColumns::valueColumnCount();
+    QVector<const float*> columns(columnCount);
+    for (int column = 0; column < columnCount; ++column) {
+        columns[column] = records.valueColumn(column).constData();
+    }
+
+    for (int row = first; row < last; ++row) {
+        if (!writer.beginRow())
+            return;
+
+        writer.writeTimestamp(records.timestamps[row]);
+        for (int column = 0; column < columnCount; ++column) {
+            writer.writeValue(columns[column][row]);
+        }
+        writer.endRow();
+    }
+}
+
+void CsvExporter::exportColumns(QPromise<Result>& promise, const QString& fileName,
+                                const QStringList& headers, const RecordColumns& records)
+{
+    static const int ROWS_PER_STEP = 64 * 1024;
+
+    Result result;
+    Writer writer(fileName);
+    if (!writer.open()) {
+        result.error = writer.errorString();
+        promise.addResult(result);
+        return;
+    }
+
+    promise.setProgressRange(0, PROGRESS_STEPS);
+    writer.writeHeader(headers);
+
+    const int rows = records.size();
+    for (int first = 0; first < rows; first += ROWS_PER_STEP) {
+        if (promise.isCanceled()) {
+            writer.discard();
+            return;
+        }
+
+        const int last = qMin(rows, first + ROWS_PER_STEP);
+        writeRows(writer, records, first, last);
+        if (writer.failed())
+            break;
+        result.rows = last;
+        promise.setProgressValue(int(qint64(last) * PROGRESS_STEPS / rows));
+    }
+
+    if (!writer.close()) {
+        result.error = writer.errorString();
+        writer.discard();
+    }
+    promise.addResult(result);
+}
+
+void CsvExporter::exportStore(QPromise<Result>& promise, const QString& fileName,
+                              const QStringList& headers, const QString& topic, qint64 fromMs, qint64 toMs)
+{
+    // One store segment per step, so cancel and progress are never far off
+    static const qint64 SLICE_MS = 60 * 60 * 1000;
+
+    Result result;
+    Writer writer(fileName);
+    if (!writer.open()) {
+        result.error = writer.errorString();
+        promise.addResult(result);
+        return;
+    }
+
+    promise.setProgressRange(0, PROGRESS_STEPS);
+    writer.writeHeader(headers);
+
+    const SampleStore store;
+    RecordColumns slice;
+    for (qint64 sliceFromMs = fromMs; sliceFromMs <= toMs; sliceFromMs += SLICE_MS) {
+        if (promise.isCanceled()) {
+            writer.discard();
+            return;
+        }
+
+        // Decoded into columns so totals use the same kernel as the table
+        const qint64 sliceToMs = qMin(toMs, sliceFromMs + SLICE_MS - 1);
+        slice.clear();
+        store.query(topic, sliceFromMs, sliceToMs, [&slice](const PowerSample& sample) { slice.append(sample); });
+        slice.computeTotals();
+
+        writeRows(writer, slice, 0, slice.size());
+        if (writer.failed())
+            break;
+        result.rows += slice.size();
+        if (toMs > fromMs) {
+            promise.setProgressValue(int((sliceToMs - fromMs) * PROGRESS_STEPS / (toMs - fromMs)));
+        }
+    }
+
+    if (!writer.close()) {
+        result.error = writer.errorString();
+        writer.discard();
+    }
+    promise.addResult(result);
+}
@@ -0,0 +1,43 @@
+// CsvExporter.h
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QPromise>
+#include <QString>
+#include <QStringList>
+#include "RecordColumns.h"
+
+// Writes history records as CSV on a worker thread, for QtConcurrent::run().
+// Rows go straight from column arrays into a large output buffer: numbers are
+// formatted with std::to_chars and timestamps with plain arithmetic, so there
+// is no QString per cell. The output matches what the record table shows:
+// ISO local timestamp, then for each ChannelSchema::TableQuantities group the
+// total and the channels, with two decimals.
+//
+// Progress is reported on the promise in [0, PROGRESS_STEPS]; cancelling the
+// future stops the export and removes the partial file.
+class CsvExporter
+{
+public:
+    struct Result {
+        qint64 rows = 0;
+        QString error;   // empty on success
+    };
+
+    static const int PROGRESS_STEPS = 1000;
+
+    // Records already in memory, e.g. what the record table holds
+    static void exportColumns(QPromise<Result>& promise, const QString& fileName,
+                              const QStringList& headers, const RecordColumns& records);
+    // Everything stored locally for [fromMs, toMs], however much that is;
+    // read from the SampleStore an hour at a time
+    static void exportStore(QPromise<Result>& promise, const QString& fileName,
+                            const QStringList& headers, const QString& topic, qint64 fromMs, qint64 toMs);
+
+private:
+    class Writer;
+
+    static void writeRows(Writer& writer, const RecordColumns& records, int first, int last);
+};
+
+#endif // CSVEXPORTER_H
@@ -0,0 +1,56 @@
+// GaugeAnimator.cpp
+#include "GaugeAnimator.h"
+#include "ModernGaugeWidget.h"
+#include <QCoreApplication>
+
+GaugeAnimator* GaugeAnimator::instance()
+{
+    // Owned by the application so it goes away with the GUI thread
+    static GaugeAnimator* animator = new GaugeAnimator(QCoreApplication::instance());
+    return animator;
+}
+
+GaugeAnimator::GaugeAnimator(QObject* parent)
+    : QObject(parent)
+{
+    m_timer.setInterval(FRAME_INTERVAL_MS);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &GaugeAnimator::tick);
+}
+
+void GaugeAnimator::animate(ModernGaugeWidget* gauge)
+{
+    if (!m_gauges.contains(gauge)) {
+        m_gauges.append(gauge);
+    }
+
+    // Waking up from idle: the first step should not include the idle time
+    if (!m_timer.isActive()) {
+        m_sinceLastTick.start();
+        m_timer.start();
+    }
+}
+
+void GaugeAnimator::remove(ModernGaugeWidget* gauge)
+{
+    m_gauges.removeAll(gauge);
+    if (m_gauges.isEmpty()) {
+        m_timer.stop();
+    }
+}
+
+void GaugeAnimator::tick()
+{
+    const qint64 elapsedMs = m_sinceLastTick.restart();
+
+    for (int i = 0; i < m_gauges.size(); ++i) {
+        ModernGaugeWidget* gauge = m_gauges[i];
+        if (!gauge || !gauge->advanceAnimation(elapsedMs)) {
+            m_gauges.removeAt(i--);
+        }
+    }
+
+    if (m_gauges.isEmpty()) {
+        m_timer.stop();
+    }
+}
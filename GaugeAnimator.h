@@ -0,0 +1,40 @@
+// GaugeAnimator.h
+#ifndef GAUGEANIMATOR_H
+#define GAUGEANIMATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+
+class ModernGaugeWidget;
+
+// One animation clock shared by every gauge. A gauge registers itself when
+// its target value changes and is advanced by the real time elapsed since
+// the previous tick until it reports that it has settled. The timer only
+// runs while at least one gauge is moving, so idle dialogs cost nothing.
+class GaugeAnimator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static GaugeAnimator* instance();
+
+    void animate(ModernGaugeWidget* gauge);
+    void remove(ModernGaugeWidget* gauge);
+
+private slots:
+    void tick();
+
+private:
+    explicit GaugeAnimator(QObject* parent = nullptr);
+
+    static const int FRAME_INTERVAL_MS = 30;
+
+    QVector<QPointer<ModernGaugeWidget>> m_gauges;
+    QTimer m_timer;
+    QElapsedTimer m_sinceLastTick;
+};
+
+#endif // GAUGEANIMATOR_H
@@ -0,0 +1,179 @@
+// GorillaBlock.cpp
+#include "GorillaBlock.h"
+#include <cstring>
+
+// Leading / trailing zero counts of a non-zero 32-bit value
+static int leadingZeros(quint32 value)
+{
+    int count = 0;
+    for (quint32 mask = 0x80000000u; !(value & mask); mask >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+static int trailingZeros(quint32 value)
+{
+    int count = 0;
+    for (; !(value & 1u); value >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+void GorillaBlock::writeBits(quint64 value, int count)
+{
+    // Bits are packed most significant first into 64-bit words
+    while (count > 0) {
+        const int offset = int(m_bitCount % 64);
+        if (offset == 0) {
+            m_words.append(0);
+        }
+        const int room = 64 - offset;
+        const int chunk = qMin(room, count);
+        const quint64 bits = (value >> (count - chunk)) & (chunk == 64 ? ~quint64(0) : (quint64(1) << chunk) - 1);
+        m_words.last() |= bits << (room - chunk);
+        m_bitCount += chunk;
+        count -= chunk;
+    }
+}
+
+void GorillaBlock::append(const PowerSample& sample)
+{
+    writeTimestamp(sample.timestampMs);
+
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        quint32 bits;
+        std::memcpy(&bits, &sample.values[channel], sizeof(float));
+        writeValue(channel, bits);
+    }
+
+    if (m_count == 0) {
+        m_firstTimestamp = sample.timestampMs;
+    }
+    m_lastTimestamp = sample.timestampMs;
+    ++m_count;
+}
+
+void GorillaBlock::writeTimestamp(qint64 timestamp)
+{
+    if (m_count == 0) {
+        writeBits(quint64(timestamp), 64);
+        return;
+    }
+
+    // Delta-of-delta with the paper's buckets, widened for millisecond clocks
+    const qint64 delta = timestamp - m_lastTimestamp;
+    const qint64 deltaOfDelta = delta - m_delta;
+    m_delta = delta;
+
+    if (deltaOfDelta == 0) {
+        writeBits(0, 1);
+    } else if (deltaOfDelta >= -63 && deltaOfDelta <= 64) {
+        writeBits(0b10, 2);
+        writeBits(quint64(deltaOfDelta + 63), 7);
+    } else if (deltaOfDelta >= -255 && deltaOfDelta <= 256) {
+        writeBits(0b110, 3);
+        writeBits(quint64(deltaOfDelta + 255), 9);
+    } else if (deltaOfDelta >= -2047 && deltaOfDelta <= 2048) {
+        writeBits(0b1110, 4);
+        writeBits(quint64(deltaOfDelta + 2047), 12);
+    } else {
+        writeBits(0b1111, 4);
+        writeBits(quint64(deltaOfDelta), 64);
+    }
+}
+
+void GorillaBlock::writeValue(int channel, quint32 bits)
+{
+    if (m_count == 0) {
+        writeBits(bits, 32);
+        m_bits[channel] = bits;
+        return;
+    }
+
+    const quint32 xored = bits ^ m_bits[channel];
+    m_bits[channel] = bits;
+
+    if (xored == 0) {
+        writeBits(0, 1);
+        return;
+    }
+
+    const int leading = leadingZeros(xored);
+    const int trailing = trailingZeros(xored);
+    const int previousTrailing = 32 - m_leading[channel] - m_meaningful[channel];
+
+    if (m_meaningful[channel] > 0 && leading >= m_leading[channel] && trailing >= previousTrailing) {
+        // Fits in the previous window of meaningful bits
+        writeBits(0b10, 2);
+        writeBits(xored >> previousTrailing, m_meaningful[channel]);
+    } else {
+        const int meaningful = 32 - leading - trailing;
+        writeBits(0b11, 2);
+        writeBits(quint64(leading), 5);
+        writeBits(quint64(meaningful - 1), 5);
+        writeBits(xored >> trailing, meaningful);
+        m_leading[channel] = leading;
+        m_meaningful[channel] = meaningful;
+    }
+}
+
+quint64 GorillaBlock::Decoder::readBits(int count)
+{
+    quint64 value = 0;
+    while (count > 0) {
+        const int offset = int(m_bitPosition % 64);
+        const int room = 64 - offset;
+        const int chunk = qMin(room, count);
+        const quint64 word = m_block.m_words[int(m_bitPosition / 64)];
+        const quint64 bits = (word >> (room - chunk)) & (chunk == 64 ? ~quint64(0) : (quint64(1) << chunk) - 1);
+        value = (chunk == 64 ? 0 : value << chunk) | bits;
+        m_bitPosition += chunk;
+        count -= chunk;
+    }
+    return value;
+}
+
+bool GorillaBlock::Decoder::next(PowerSample& sample)
+{
+    if (m_index >= m_block.m_count)
+        return false;
+
+    if (m_index == 0) {
+        m_timestamp = qint64(readBits(64));
+    } else {
+        qint64 deltaOfDelta;
+        if (!readBit()) {
+            deltaOfDelta = 0;
+        } else if (!readBit()) {
+            deltaOfDelta = qint64(readBits(7)) - 63;
+        } else if (!readBit()) {
+            deltaOfDelta = qint64(readBits(9)) - 255;
+        } else if (!readBit()) {
+            deltaOfDelta = qint64(readBits(12)) - 2047;
+        } else {
+            deltaOfDelta = qint64(readBits(64));
+        }
+        m_delta += deltaOfDelta;
+        m_timestamp += m_delta;
+    }
+    sample.timestampMs = m_timestamp;
+
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        if (m_index == 0) {
+            m_bits[channel] = quint32(readBits(32));
+        } else if (readBit()) {
+            if (readBit()) {
+                m_leading[channel] = int(readBits(5));
+                m_meaningful[channel] = int(readBits(5)) + 1;
+            }
+            const int trailing = 32 - m_leading[channel] - m_meaningful[channel];
+            m_bits[channel] ^= quint32(readBits(m_meaningful[channel])) << trailing;
+        }
+        std::memcpy(&sample.values[channel], &m_bits[channel], sizeof(float));
+    }
+
+    ++m_index;
+    return true;
+}
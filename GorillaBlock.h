@@ -0,0 +1,66 @@
+// GorillaBlock.h
+#ifndef GORILLABLOCK_H
+#define GORILLABLOCK_H
+
+#include <QVector>
+#include "PowerSample.h"
+
+// Compressed run of consecutive samples, encoded as in Facebook's Gorilla
+// (Pelkonen et al., VLDB 2015): timestamps as delta-of-deltas, every channel
+// as the XOR with its previous value, both with variable-length bit codes.
+// Regular 1 Hz readings cost about one bit per timestamp and a few bits per
+// slowly changing value, instead of 44 bytes per raw sample. Blocks are
+// append-only; Decoder walks one from the start.
+class GorillaBlock
+{
+public:
+    void append(const PowerSample& sample);
+    // Releases spare capacity once no more samples will be appended
+    void seal() { m_words.squeeze(); }
+
+    int size() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+    qint64 firstTimestamp() const { return m_firstTimestamp; }
+    qint64 lastTimestamp() const { return m_lastTimestamp; }
+    qint64 memoryUsage() const { return sizeof(GorillaBlock) + qint64(m_words.capacity()) * sizeof(quint64); }
+
+    class Decoder
+    {
+    public:
+        explicit Decoder(const GorillaBlock& block) : m_block(block) {}
+        // Decodes the next sample; false once the block is exhausted
+        bool next(PowerSample& sample);
+
+    private:
+        quint64 readBits(int count);
+        bool readBit() { return readBits(1); }
+
+        const GorillaBlock& m_block;
+        qint64 m_bitPosition = 0;
+        int m_index = 0;
+        qint64 m_timestamp = 0;
+        qint64 m_delta = 0;
+        quint32 m_bits[ChannelSchema::ChannelCount] = {};
+        int m_leading[ChannelSchema::ChannelCount] = {};
+        int m_meaningful[ChannelSchema::ChannelCount] = {};
+    };
+
+private:
+    void writeBits(quint64 value, int count);
+    void writeTimestamp(qint64 timestamp);
+    void writeValue(int channel, quint32 bits);
+
+    QVector<quint64> m_words;
+    qint64 m_bitCount = 0;
+    int m_count = 0;
+    qint64 m_firstTimestamp = 0;
+    qint64 m_lastTimestamp = 0;
+
+    // Encoder state, mirrored by Decoder
+    qint64 m_delta = 0;
+    quint32 m_bits[ChannelSchema::ChannelCount] = {};
+    int m_leading[ChannelSchema::ChannelCount] = {};
+    int m_meaningful[ChannelSchema::ChannelCount] = {};
+};
+
+#endif // GORILLABLOCK_H
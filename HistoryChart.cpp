@@ -0,0 +1,367 @@
+// HistoryChart.cpp
+#include "HistoryChart.h"
+#include "ApiClient.h"
+#include "RenderScheduler.h"
+#include "SampleStore.h"
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QHBoxLayout>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrentRun>
+
+HistoryChart::HistoryChart(const QString& clusterId, const QString& topic, const QColor& color, QWidget* parent)
+    : QWidget(parent),
+    m_clusterId(clusterId),
+    m_topic(topic),
+    m_color(color),
+    m_valueRange(1.0)
+{
+    setupUI();
+
+    // Frames are coalesced by the shared scheduler, and none is rendered
+    // (so nothing is loaded) while the chart is not on screen
+    RenderScheduler::instance()->addTarget(m_chartView, [this]() { render(); });
+}
+
+HistoryChart::~HistoryChart()
+{
+    // Tile requests still in flight are left to finish; another chart of the
+    // same location may be waiting for them too
+    RenderScheduler::instance()->removeTarget(m_chartView);
+}
+
+void HistoryChart::setupUI()
+{
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout* controlLayout = new QHBoxLayout();
+    m_quantitySelector = new QComboBox();
+    for (ChannelSchema::Quantity quantity : ChannelSchema::ChartQuantities) {
+        m_quantitySelector->addItem(ChannelSchema::axisTitle(quantity));
+    }
+    connect(m_quantitySelector, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() {
+        m_valueRange = NiceAxisRange(1.0);
+        RenderScheduler::instance()->markDirty(m_chartView);
+    });
+
+    m_resetZoomButton = new QPushButton("Reset Zoom");
+    connect(m_resetZoomButton, &QPushButton::clicked, this, &HistoryChart::resetZoom);
+
+    m_statusLabel = new QLabel();
+    controlLayout->addWidget(m_quantitySelector);
+    controlLayout->addWidget(m_resetZoomButton);
+    controlLayout->addWidget(m_statusLabel, 1);
+    layout->addLayout(controlLayout);
+
+    m_chart = new QChart();
+    m_chart->legend()->hide();
+
+    m_timeAxis = new QDateTimeAxis();
+    m_timeAxis->setFormat("yyyy-MM-dd HH:mm");
+    m_timeAxis->setTitleText("Time");
+    m_valueAxis = new QValueAxis();
+    m_chart->addAxis(m_timeAxis, Qt::AlignBottom);
+    m_chart->addAxis(m_valueAxis, Qt::AlignLeft);
+
+    // Minimum to maximum of every bucket as a band, the average on top
+    m_minimumSeries = new QLineSeries(this);
+    m_maximumSeries = new QLineSeries(this);
+    m_rangeSeries = new QAreaSeries(m_maximumSeries, m_minimumSeries);
+    QColor band = m_color;
+    band.setAlpha(70);
+    m_rangeSeries->setBrush(band);
+    m_rangeSeries->setPen(Qt::NoPen);
+    m_averageSeries = new QLineSeries();
+    m_averageSeries->setPen(QPen(m_color, 2));
+
+    for (QAbstractSeries* series : {static_cast<QAbstractSeries*>(m_rangeSeries),
+                                    static_cast<QAbstractSeries*>(m_averageSeries)}) {
+        m_chart->addSeries(series);
+        series->attachAxis(m_timeAxis);
+        series->attachAxis(m_valueAxis);
+    }
+
+    // Drag to zoom into a time span, right-click to zoom out
+    m_chartView = new QChartView(m_chart);
+    m_chartView->setRenderHint(QPainter::Antialiasing);
+    m_chartView->setRubberBand(QChartView::HorizontalRubberBand);
+    layout->addWidget(m_chartView, 1);
+
+    connect(m_timeAxis, &QDateTimeAxis::rangeChanged, this, [this]() {
+        RenderScheduler::instance()->markDirty(m_chartView);
+    });
+}
+
+void HistoryChart::setWindow(qint64 fromMs, qint64 toMs)
+{
+    // Back from records in memory to the store and the backend
+    if (!m_records.isEmpty()) {
+        changeSource(RecordColumns());
+    }
+
+    m_windowFromMs = fromMs;
+    m_windowToMs = qMax(toMs, fromMs + 1);
+
+    // Whatever may have changed since it was loaded goes
+    for (auto tile = m_tiles.begin(); tile != m_tiles.end();) {
+        if (tile->settled) {
+            ++tile;
+        } else {
+            tile = m_tiles.erase(tile);
+        }
+    }
+    m_lastError.clear();
+
+    resetZoom();
+}
+
+void HistoryChart::showRecords(const RecordColumns& records)
+{
+    changeSource(records);
+    if (records.isEmpty())
+        return;
+
+    m_windowFromMs = records.timestamps.first();
+    m_windowToMs = qMax(records.timestamps.last(), m_windowFromMs + 1);
+    m_lastError.clear();
+    resetZoom();
+}
+
+void HistoryChart::changeSource(const RecordColumns& records)
+{
+    // Tiles of the old source, loaded or on their way, no longer apply
+    m_records = records;
+    ++m_source;
+    m_tiles.clear();
+    m_queue.clear();
+    m_loading.clear();
+}
+
+void HistoryChart::resetZoom()
+{
+    m_chart->zoomReset();
+    m_timeAxis->setRange(QDateTime::fromMSecsSinceEpoch(m_windowFromMs), QDateTime::fromMSecsSinceEpoch(m_windowToMs));
+    m_valueRange = NiceAxisRange(1.0);
+    RenderScheduler::instance()->markDirty(m_chartView);
+}
+
+void HistoryChart::render()
+{
+    if (m_windowToMs <= m_windowFromMs)
+        return;
+
+    const qint64 fromMs = m_timeAxis->min().toMSecsSinceEpoch();
+    const qint64 toMs = m_timeAxis->max().toMSecsSinceEpoch();
+    const qreal width = m_chart->plotArea().width() > 0 ? m_chart->plotArea().width() : m_chartView->width();
+
+    // Finest resolution with no more buckets than pixels
+    int resolution = 0;
+    while (resolution < RESOLUTION_COUNT - 1 && (toMs - fromMs) / BUCKET_MS[resolution] > width) {
+        ++resolution;
+    }
+
+    requestTiles(resolution, fromMs, toMs);
+
+    m_averagePoints.clear();
+    m_minimumPoints.clear();
+    m_maximumPoints.clear();
+    // Every bucket at least partly in view
+    const qint64 bucketMs = BUCKET_MS[resolution];
+    collectBuckets(resolution, fromMs - fromMs % bucketMs, toMs + bucketMs);
+
+    m_averageSeries->replace(m_averagePoints);
+    m_minimumSeries->replace(m_minimumPoints);
+    m_maximumSeries->replace(m_maximumPoints);
+
+    if (!m_minimumPoints.isEmpty()) {
+        double minValue = m_minimumPoints.first().y();
+        double maxValue = m_maximumPoints.first().y();
+        for (int point = 0; point < m_minimumPoints.size(); ++point) {
+            minValue = qMin(minValue, m_minimumPoints[point].y());
+            maxValue = qMax(maxValue, m_maximumPoints[point].y());
+        }
+        if (m_valueRange.update(minValue, maxValue)) {
+            m_valueAxis->setRange(m_valueRange.lower(), m_valueRange.upper());
+        }
+    }
+
+    updateStatus(resolution);
+}
+
+void HistoryChart::requestTiles(int resolution, qint64 fromMs, qint64 toMs)
+{
+    // Only what this frame shows is worth waiting for
+    m_queue.clear();
+
+    const qint64 tileSpan = TILE_BUCKETS * BUCKET_MS[resolution];
+    for (qint64 index = fromMs / tileSpan; index * tileSpan <= toMs; ++index) {
+        const TileKey key(resolution, index);
+        auto tile = m_tiles.find(key);
+        if (tile != m_tiles.end()) {
+            tile->lastUsed = ++m_clock;
+        } else if (!m_loading.contains(key)) {
+            m_queue.append(key);
+        }
+    }
+
+    startRequests();
+}
+
+void HistoryChart::startRequests()
+{
+    while (!m_queue.isEmpty() && m_loading.size() < MAX_REQUESTS) {
+        const TileKey key = m_queue.takeFirst();
+        m_loading.insert(key);
+        loadTile(key);
+    }
+}
+
+void HistoryChart::loadTile(const TileKey& key)
+{
+    const qint64 fromMs = tileStart(key);
+    const qint64 toMs = tileEnd(key);
+    const qint64 bucketMs = BUCKET_MS[key.first];
+    const bool settled = toMs <= QDateTime::currentMSecsSinceEpoch() - SETTLE_MS;
+
+    // Records shown from memory are complete by definition
+    if (!m_records.isEmpty()) {
+        const RecordColumns records = m_records;
+        aggregate(key, true, [records, bucketMs, fromMs, toMs]() {
+            return BucketColumns::fromColumns(records, bucketMs, fromMs, toMs);
+        });
+        return;
+    }
+
+    // Aggregated here when the local store holds the whole tile; a tile
+    // touching a time this client was offline comes from the backend
+    if (SampleStore().covers(m_topic, fromMs, toMs)) {
+        const QString topic = m_topic;
+        aggregate(key, settled, [topic, bucketMs, fromMs, toMs]() {
+            return BucketColumns::fromStore(topic, bucketMs, fromMs, toMs);
+        });
+        return;
+    }
+
+    QJsonObject requestObj;
+    requestObj["cluster_id"] = m_clusterId;
+    requestObj["topic_name"] = m_topic;
+    requestObj["start_time"] = QDateTime::fromMSecsSinceEpoch(fromMs).toString(Qt::ISODate);
+    requestObj["end_time"] = QDateTime::fromMSecsSinceEpoch(toMs).toString(Qt::ISODate);
+    requestObj["bucket_seconds"] = bucketMs / 1000;
+
+    QNetworkRequest request = ApiClient::instance()->request("/recordBuckets");
+    request.setRawHeader("Accept", "application/x-ndjson");
+
+    // Two charts of the same location share the request
+    ApiClient::instance()->fetch(request, "GET", QJsonDocument(requestObj).toJson(QJsonDocument::Compact), this,
+                                 [this, key, settled, source = m_source](const ApiClient::Response& response) {
+                                     if (source == m_source) {
+                                         onTileFetched(key, settled, response);
+                                     }
+                                 });
+}
+
+void HistoryChart::onTileFetched(const TileKey& key, bool settled, const ApiClient::Response& response)
+{
+    if (response.error != QNetworkReply::NoError) {
+        // Not asked for again until the next setWindow()
+        m_lastError = response.errorString;
+        storeTile(key, BucketColumns(), false);
+        return;
+    }
+
+    // Tiles are small; decoding still stays off the GUI thread
+    const QByteArray body = response.body;
+    const qint64 fromMs = tileStart(key);
+    const qint64 toMs = tileEnd(key);
+    aggregate(key, settled, [body, fromMs, toMs]() { return BucketColumns::fromNdjson(body, fromMs, toMs); });
+}
+
+void HistoryChart::aggregate(const TileKey& key, bool settled, const std::function<BucketColumns()>& job)
+{
+    QFutureWatcher<BucketColumns>* watcher = new QFutureWatcher<BucketColumns>(this);
+    connect(watcher, &QFutureWatcher<BucketColumns>::finished, this, [this, watcher, key, settled, source = m_source]() {
+        watcher->deleteLater();
+        if (source != m_source)
+            return;
+
+        const BucketColumns buckets = watcher->result();
+        storeTile(key, buckets, settled && buckets.malformed == 0);
+    });
+    watcher->setFuture(QtConcurrent::run(job));
+}
+
+void HistoryChart::storeTile(const TileKey& key, const BucketColumns& buckets, bool settled)
+{
+    m_loading.remove(key);
+
+    Tile& tile = m_tiles[key];
+    tile.buckets = buckets;
+    tile.lastUsed = ++m_clock;
+    tile.settled = settled;
+
+    while (m_tiles.size() > MAX_TILES) {
+        auto oldest = m_tiles.begin();
+        for (auto candidate = m_tiles.begin(); candidate != m_tiles.end(); ++candidate) {
+            if (candidate->lastUsed < oldest->lastUsed) {
+                oldest = candidate;
+            }
+        }
+        m_tiles.erase(oldest);
+    }
+
+    startRequests();
+    RenderScheduler::instance()->markDirty(m_chartView);
+}
+
+void HistoryChart::collectBuckets(int resolution, qint64 fromMs, qint64 toMs)
+{
+    const ChannelSchema::Quantity quantity = ChannelSchema::ChartQuantities[qMax(0, m_quantitySelector->currentIndex())];
+    const qint64 tileSpan = TILE_BUCKETS * BUCKET_MS[resolution];
+
+    for (qint64 index = fromMs / tileSpan; index * tileSpan < toMs; ++index) {
+        const TileKey key(resolution, index);
+        const qint64 spanFrom = qMax(fromMs, tileStart(key));
+        const qint64 spanTo = qMin(toMs, tileEnd(key));
+
+        auto tile = m_tiles.constFind(key);
+        if (tile == m_tiles.cend()) {
+            if (resolution + 1 < RESOLUTION_COUNT) {
+                collectBuckets(resolution + 1, spanFrom, spanTo);
+            }
+            continue;
+        }
+
+        // Points at bucket centres; a bucket belongs to the span holding its
+        // centre, so coarser stand-ins neither overlap nor leave holes
+        const BucketColumns& buckets = tile->buckets;
+        const qint64 halfBucket = BUCKET_MS[resolution] / 2;
+        for (int row = 0; row < buckets.size(); ++row) {
+            const qint64 centreMs = buckets.timestamps[row] + halfBucket;
+            if (centreMs < spanFrom || centreMs >= spanTo)
+                continue;
+
+            const qreal x = centreMs;
+            m_averagePoints.append(QPointF(x, buckets.total(BucketColumns::Average, quantity, row)));
+            m_minimumPoints.append(QPointF(x, buckets.total(BucketColumns::Minimum, quantity, row)));
+            m_maximumPoints.append(QPointF(x, buckets.total(BucketColumns::Maximum, quantity, row)));
+        }
+    }
+}
+
+void HistoryChart::updateStatus(int resolution)
+{
+    static const char* const ResolutionNames[RESOLUTION_COUNT] = {"1 min", "15 min", "1 h"};
+
+    QString status = QString("%1 buckets").arg(ResolutionNames[resolution]);
+    if (!m_loading.isEmpty() || !m_queue.isEmpty()) {
+        status += QString(", loading %1 tiles").arg(m_loading.size() + m_queue.size());
+    }
+    if (!m_lastError.isEmpty()) {
+        status += QString(" - some history unavailable: %1").arg(m_lastError);
+    }
+    m_statusLabel->setText(status);
+}
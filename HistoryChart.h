@@ -0,0 +1,132 @@
+// HistoryChart.h
+#ifndef HISTORYCHART_H
+#define HISTORYCHART_H
+
+#include <QWidget>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QVector>
+#include <functional>
+#include <QColor>
+#include <QLabel>
+#include <QComboBox>
+#include <QPushButton>
+#include <QChartView>
+#include <QChart>
+#include <QLineSeries>
+#include <QAreaSeries>
+#include <QDateTimeAxis>
+#include <QValueAxis>
+#include "ApiClient.h"
+#include "BucketColumns.h"
+#include "NiceAxisRange.h"
+#include "RecordColumns.h"
+
+// Zoomable history of one location, drawn from aggregated buckets instead of
+// raw records. The time axis is cut into tiles of TILE_BUCKETS buckets at
+// three resolutions (1 min, 15 min, 1 h). Each frame shows the finest
+// resolution that keeps about one bucket per pixel, and loads only the tiles
+// of that resolution inside the visible range. Until a tile arrives, its span
+// is drawn from coarser tiles already loaded, so zooming in sharpens
+// progressively. Transfer and drawing therefore follow the width of the
+// chart, whatever the length of the window or the sample rate.
+//
+// Tiles the local store covers are computed from it; older ones come from
+// the backend's /recordBuckets. Loaded tiles are kept, least recently used
+// ones dropped beyond MAX_TILES.
+class HistoryChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    HistoryChart(const QString& clusterId, const QString& topic, const QColor& color, QWidget* parent = nullptr);
+    ~HistoryChart();
+
+    // Shows [fromMs, toMs] unzoomed
+    void setWindow(qint64 fromMs, qint64 toMs);
+    // Shows the whole of the given records instead, e.g. an opened archive;
+    // the next setWindow() goes back to the store and the backend
+    void showRecords(const RecordColumns& records);
+
+private slots:
+    void resetZoom();
+
+private:
+    // (resolution, tile index since the epoch)
+    using TileKey = QPair<int, qint64>;
+
+    struct Tile {
+        BucketColumns buckets;
+        quint64 lastUsed = 0;
+        // Tiles reaching into the last minutes may still grow, and failed
+        // ones are empty; neither survives the next setWindow()
+        bool settled = true;
+    };
+
+    static constexpr qint64 BUCKET_MS[] = {60 * 1000, 15 * 60 * 1000, 60 * 60 * 1000};
+    static constexpr int RESOLUTION_COUNT = sizeof(BUCKET_MS) / sizeof(BUCKET_MS[0]);
+    static const int TILE_BUCKETS = 256;
+    static const int MAX_TILES = 256;
+    static const int MAX_REQUESTS = 4;
+    static constexpr qint64 SETTLE_MS = 60 * 1000;
+
+    static qint64 tileStart(const TileKey& key) { return key.second * TILE_BUCKETS * BUCKET_MS[key.first]; }
+    static qint64 tileEnd(const TileKey& key) { return tileStart(key) + TILE_BUCKETS * BUCKET_MS[key.first]; }
+
+    void setupUI();
+    // Render callback: picks the resolution, asks for missing tiles and
+    // rebuilds the series from what is loaded
+    void render();
+    void requestTiles(int resolution, qint64 fromMs, qint64 toMs);
+    void startRequests();
+    void loadTile(const TileKey& key);
+    // Runs a tile's aggregation or decoding on the pool
+    void aggregate(const TileKey& key, bool settled, const std::function<BucketColumns()>& job);
+    void changeSource(const RecordColumns& records);
+    void onTileFetched(const TileKey& key, bool settled, const ApiClient::Response& response);
+    void storeTile(const TileKey& key, const BucketColumns& buckets, bool settled);
+    // Buckets over [fromMs, toMs) at the given resolution, from coarser
+    // tiles where a tile is not loaded yet
+    void collectBuckets(int resolution, qint64 fromMs, qint64 toMs);
+    void updateStatus(int resolution);
+
+    QString m_clusterId;
+    QString m_topic;
+    QColor m_color;
+    qint64 m_windowFromMs = 0;
+    qint64 m_windowToMs = 0;
+
+    QChart* m_chart;
+    QChartView* m_chartView;
+    QDateTimeAxis* m_timeAxis;
+    QValueAxis* m_valueAxis;
+    QLineSeries* m_averageSeries;
+    QLineSeries* m_minimumSeries;
+    QLineSeries* m_maximumSeries;
+    QAreaSeries* m_rangeSeries;
+    QComboBox* m_quantitySelector;
+    QPushButton* m_resetZoomButton;
+    QLabel* m_statusLabel;
+    NiceAxisRange m_valueRange;
+
+    // Records in memory the tiles are aggregated from, if not empty
+    RecordColumns m_records;
+    // Bumped when the tiles' source changes; late tiles of an older one are dropped
+    int m_source = 0;
+
+    QHash<TileKey, Tile> m_tiles;
+    quint64 m_clock = 0;
+    // Wanted by the last frame, finest resolution first, not yet requested
+    QVector<TileKey> m_queue;
+    // Requested or being computed
+    QSet<TileKey> m_loading;
+    QString m_lastError;
+
+    // Scratch buffers of render()
+    QList<QPointF> m_averagePoints;
+    QList<QPointF> m_minimumPoints;
+    QList<QPointF> m_maximumPoints;
+};
+
+#endif // HISTORYCHART_H
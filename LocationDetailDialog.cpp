@@ -7,32 +7,32 @@
 #include <QApplication>
 #include <QScreen>
 #include <QStyle>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QTextEdit>
-#include <QtWebSockets/QWebSocket>
 #include <QMessageBox>
 #include <QDebug>
 #include <QDateTime>
 #include <QPushButton>
+#include <QSignalBlocker>
 
-LocationDetailDialog::LocationDetailDialog(QString& name ,QString& topic,QWebSocket* socket,QWidget *parent)
+LocationDetailDialog::LocationDetailDialog(QString& name ,QString& topic,SampleIngest* ingest,QWidget *parent)
     : QDialog(parent)
 {
     this->m_name = name;
     this->m_topic = topic;
-    this->m_socket = socket;
+    this->m_ingest = ingest;
 
     this->setUI();
 
-    connect(m_socket, &QWebSocket::textMessageReceived, this, &LocationDetailDialog::handleSocketMessage);
-
-    // Optional: disconnect on dialog close
-    connect(this, &QDialog::finished, this, [this]() {
-        disconnect(m_socket, &QWebSocket::textMessageReceived, this, &LocationDetailDialog::handleSocketMessage);
+    // Hold our own reference on the topic and read the already decoded samples
+    m_topicId = m_ingest->subscribe(m_topic);
+    m_ingest->bus()->subscribe(m_topicId, this, [this](const PowerSample& sample) {
+        handleSample(sample);
     });
+}
 
-
+LocationDetailDialog::~LocationDetailDialog()
+{
+    m_ingest->bus()->unsubscribeAll(this);
+    m_ingest->unsubscribe(m_topicId);
 }
 
 void LocationDetailDialog::setUI() {
@@ -55,47 +55,31 @@ void LocationDetailDialog::setUI() {
     m_gaugeLayout->setSpacing(20);
 
     // Create phase labels
-    QStringList phaseLabels = {"Phase 1", "Phase 2", "Phase 3"};
-    for (int col = 0; col < 3; ++col) {
-        QLabel *phaseLabel = new QLabel(phaseLabels[col], this);
+    for (int col = 0; col < ChannelSchema::PhaseCount; ++col) {
+        QLabel *phaseLabel = new QLabel(QString("Phase %1").arg(col + 1), this);
         phaseLabel->setAlignment(Qt::AlignCenter);
         phaseLabel->setStyleSheet("color: #FFFFFF; font-size: 18px; font-weight: bold;");
         m_gaugeLayout->addWidget(phaseLabel, 0, col);
     }
 
-    // Create row labels
-    QStringList rowLabels = {"Voltage", "Current", "Power"};
-    for (int row = 0; row < 3; ++row) {
-        QLabel *rowLabel = new QLabel(rowLabels[row], this);
+    // Create row labels, one row per quantity
+    for (int row = 0; row < ChannelSchema::QuantityCount; ++row) {
+        QLabel *rowLabel = new QLabel(ChannelSchema::Quantities[row].name, this);
         rowLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
         rowLabel->setStyleSheet("color: #FFFFFF; font-size: 18px; font-weight: bold;");
-        m_gaugeLayout->addWidget(rowLabel, row + 1, 3);
+        m_gaugeLayout->addWidget(rowLabel, row + 1, ChannelSchema::PhaseCount);
     }
 
-    // Create gauges
-    QColor voltageColor(0, 255, 170);  // Turquoise like in the image
-    QColor currentColor(255, 100, 100);  // Red
-    QColor powerColor(100, 150, 255);    // Blue
-
-    // Populate gauges
-    for (int col = 0; col < 3; ++col) {
-        // Voltage gauge
-        ModernGaugeWidget *voltageGauge = new ModernGaugeWidget(
-            "VOLTAGE", "", 0, 500, "V", voltageColor, this);
-        m_gaugeLayout->addWidget(voltageGauge, 1, col);
-        m_gauges.append(voltageGauge);
-
-        // Current gauge
-        ModernGaugeWidget *currentGauge = new ModernGaugeWidget(
-            "CURRENT", "", 0, 100, "A", currentColor, this);
-        m_gaugeLayout->addWidget(currentGauge, 2, col);
-        m_gauges.append(currentGauge);
-
-        // Power gauge
-        ModernGaugeWidget *powerGauge = new ModernGaugeWidget(
-            "POWER", "", 0, 5000, "W", powerColor, this);
-        m_gaugeLayout->addWidget(powerGauge, 3, col);
-        m_gauges.append(powerGauge);
+    // Populate gauges, one per channel; m_gauges is indexed by channel
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        const ChannelSchema::ChannelInfo& info = ChannelSchema::Channels[channel];
+        const ChannelSchema::QuantityInfo& quantity = ChannelSchema::Quantities[info.quantity];
+
+        ModernGaugeWidget *gauge = new ModernGaugeWidget(
+            quantity.gaugeTitle, "", quantity.gaugeMin, quantity.gaugeMax, quantity.unit,
+            QColor(QRgb(quantity.gaugeColor)), this);
+        m_gaugeLayout->addWidget(gauge, info.quantity + 1, info.phase);
+        m_gauges.append(gauge);
     }
 
     mainLayout->addLayout(m_gaugeLayout);
@@ -164,107 +148,43 @@ void LocationDetailDialog::setUI() {
 
 void LocationDetailDialog::toggleDevice(bool checked)
 {
+    // The device keeps its state unless the command actually went out
+    if (!sendDeviceCommand(checked ? "MOTOR ON" : "MOTOR OFF")) {
+        const QSignalBlocker blocker(m_deviceToggleButton);
+        m_deviceToggleButton->setChecked(m_deviceRunning);
+        return;
+    }
+
     m_deviceRunning = checked;
 
     if (m_deviceRunning) {
         m_deviceToggleButton->setText("Turn Device OFF");
         m_deviceStatusLabel->setText("Device Status: ON");
-        sendDeviceCommand("MOTOR ON");
     } else {
         m_deviceToggleButton->setText("Turn Device ON");
         m_deviceStatusLabel->setText("Device Status: OFF");
-        sendDeviceCommand("MOTOR OFF");
     }
 }
 
-// void LocationDetailDialog::sendDeviceCommand(const QString &command)
-// {
-//     if (m_socket && m_socket->isValid()) {
-//         // Assuming deviceId is stored in the class or can be retrieved
-//         // QString deviceId = this->m_id; // Use your actual device ID variable
-
-//         // Create a JSON message
-//         QJsonObject jsonMessage;
-//         // jsonMessage["device_id"] = deviceId;
-//         jsonMessage["command"] = command;
-//         // jsonMessage["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-
-//         QJsonDocument doc(jsonMessage);
-//         QString message = doc.toJson(QJsonDocument::Compact);
-
-//         // Send the message through WebSocket
-//         m_socket->sendTextMessage(message);
-
-//         qDebug() << "Sent command to device:" << "-" << command;
-//     } else {
-//         qWarning() << "WebSocket is not connected. Cannot send command:" << command;
-
-//         // Optional: Show message to user
-//         QMessageBox::warning(this, "Connection Error",
-//                              "Cannot send command - WebSocket is not connected.",
-//                              QMessageBox::Ok);
-//     }
-// }
-
-void LocationDetailDialog::sendDeviceCommand(const QString &command)
+bool LocationDetailDialog::sendDeviceCommand(const QString &command)
 {
-    if (m_socket && m_socket->isValid()) {
-        // Send the plain text message directly
-        m_socket->sendTextMessage(command);
+    // Sent as a command for our topic over the shared connection
+    if (m_ingest->sendCommand(m_topicId, command))
+        return true;
 
-        qDebug() << "Sent command to device:" << "-" << command;
-    } else {
-        qWarning() << "WebSocket is not connected. Cannot send command:" << command;
+    qWarning() << "WebSocket is not connected. Cannot send command:" << command;
 
-        // Optional: Show message to user
-        QMessageBox::warning(this, "Connection Error",
-                             "Cannot send command - WebSocket is not connected.",
-                             QMessageBox::Ok);
-    }
+    // Optional: Show message to user
+    QMessageBox::warning(this, "Connection Error",
+                         "Cannot send command - WebSocket is not connected.",
+                         QMessageBox::Ok);
+    return false;
 }
 
 
-void LocationDetailDialog::handleSocketMessage(const QString &message) {  // 🛠 fixed spelling
-    QJsonParseError parseError;
-    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
-
-    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
-        qWarning() << "Failed to parse JSON:" << parseError.errorString();
-        return;
-    }
-
-    QJsonObject obj = doc.object();
-
-    if (obj.contains("v1") && obj.contains("v2") && obj.contains("v3") && obj.contains("c1") && obj.contains("c2") && obj.contains("c3") && obj.contains("p1") && obj.contains("p2") && obj.contains("p3")) {
-        double v1 = obj["v1"].toDouble();
-        double v2 = obj["v2"].toDouble();
-        double v3 = obj["v3"].toDouble();
-        double c1 = obj["c1"].toDouble();
-        double c2 = obj["c2"].toDouble();
-        double c3 = obj["c3"].toDouble();
-        double p1 = obj["p1"].toDouble();
-        double p2 = obj["p2"].toDouble();
-        double p3 = obj["p3"].toDouble();
-
-        qDebug() << "[Dialog JSON] Voltage:" << v1 <<" "<< v2 <<" "<< v3
-                 << "Current:" << c1 <<" " << c2 << " " << c3
-                 << "Power:" << p1 <<" " << p2 << " " << p3;
-
-
-        m_gauges[0]->setValue(v1);
-        m_gauges[1]->setValue(c1);
-        m_gauges[2]->setValue(p1);
-        m_gauges[3]->setValue(v2);
-        m_gauges[4]->setValue(c2);
-        m_gauges[5]->setValue(p2);
-        m_gauges[6]->setValue(v3);
-        m_gauges[7]->setValue(c3);
-        m_gauges[8]->setValue(p3);
-
-
-        // Update your UI here
-    } else {
-        qWarning() << "JSON missing expected keys";
+void LocationDetailDialog::handleSample(const PowerSample& sample) {
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        m_gauges[channel]->setValue(sample.values[channel]);
     }
 }
 
@@ -7,7 +7,7 @@
 #include <QGridLayout>
 #include "ModernGaugeWidget.h"
 #include "ScheduleManagerDialog.h"
-#include <QtWebSockets/QWebSocket>
+#include "SampleIngest.h"
 #include <QLabel>
 #include <QPushButton>
 
@@ -17,7 +17,8 @@ class LocationDetailDialog : public QDialog
 
 public:
 
-    LocationDetailDialog(QString& name,QString& topic,QWebSocket* socket, QWidget *parent = nullptr);
+    LocationDetailDialog(QString& name,QString& topic,SampleIngest* ingest, QWidget *parent = nullptr);
+    ~LocationDetailDialog();
 
     void setUI();
 
@@ -26,12 +27,14 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
 
 private slots:
-    void handleSocketMessage(const QString& message);
     void toggleDevice(bool checked);
-    void sendDeviceCommand(const QString &command);
+    bool sendDeviceCommand(const QString &command);
 
 private:
-    QWebSocket* m_socket;
+    void handleSample(const PowerSample& sample);
+
+    SampleIngest* m_ingest;
+    int m_topicId;
     QString m_name;
     QString m_topic;
     QGridLayout *m_gaugeLayout;
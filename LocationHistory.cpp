@@ -0,0 +1,205 @@
+// LocationHistory.cpp
+#include "LocationHistory.h"
+#include "MemoryBudget.h"
+
+LocationHistory::LocationHistory(const QString& name, qint64 retentionMs)
+    : m_name(name),
+    m_retentionMs(qMax<qint64>(1, retentionMs)),
+    m_hot(MIN_HOT_CAPACITY)
+{
+    MemoryBudget::instance()->registerHistory(this);
+}
+
+LocationHistory::~LocationHistory()
+{
+    MemoryBudget::instance()->unregisterHistory(this);
+}
+
+void LocationHistory::setRetention(qint64 retentionMs)
+{
+    m_retentionMs = qMax<qint64>(1, retentionMs);
+    if (!m_hot.isEmpty()) {
+        applyRetention(m_hot.lastTimestamp());
+    }
+}
+
+void LocationHistory::append(const PowerSample& sample)
+{
+    if (m_hot.isFull()) {
+        const bool inWindow = m_hot.firstTimestamp() >= sample.timestampMs - m_retentionMs;
+        if (inWindow && m_hot.capacity() < MAX_HOT_CAPACITY) {
+            // Grow the hot ring first, if the budget allows it
+            const int grown = qMin(2 * m_hot.capacity(), MAX_HOT_CAPACITY);
+            const qint64 extra = qint64(grown - m_hot.capacity()) * SampleRingBuffer::BytesPerSample;
+            if (MemoryBudget::instance()->requestGrowth(extra)) {
+                m_hot.setCapacity(grown);
+            }
+        }
+        if (m_hot.isFull() && inWindow) {
+            // Then move the oldest hot sample to the cold tier
+            spillOldest();
+        }
+    }
+
+    m_hot.append(sample);
+    m_summaries.append(sample);
+    applyRetention(sample.timestampMs);
+}
+
+void LocationHistory::spillOldest()
+{
+    if (m_cold.isEmpty() || m_cold.last().size() >= COLD_BLOCK_SAMPLES) {
+        if (!m_cold.isEmpty()) {
+            // The cold tier is what grows with the retention, so every
+            // sealed block is charged to the budget
+            m_cold.last().seal();
+            MemoryBudget::instance()->charge(m_cold.last().memoryUsage());
+        }
+        m_cold.append(GorillaBlock());
+    }
+
+    PowerSample oldest;
+    oldest.timestampMs = m_hot.firstTimestamp();
+    for (int column = 0; column < SampleRingBuffer::ColumnCount; ++column) {
+        oldest.values[column] = m_hot.valueAt(column, 0);
+    }
+    m_cold.last().append(oldest);
+    m_hot.dropOldest(1);
+}
+
+qint64 LocationHistory::firstTimestamp() const
+{
+    const qint64 raw = firstRawTimestamp();
+    return m_summaries.isEmpty() ? raw : qMin(raw, m_summaries.firstTimestamp());
+}
+
+qint64 LocationHistory::firstRawTimestamp() const
+{
+    return m_cold.isEmpty() ? m_hot.firstTimestamp() : m_cold.first().firstTimestamp();
+}
+
+qint64 LocationHistory::memoryUsage() const
+{
+    qint64 bytes = m_hot.memoryUsage() + m_summaries.memoryUsage();
+    for (const GorillaBlock& block : m_cold) {
+        bytes += block.memoryUsage();
+    }
+    return bytes;
+}
+
+int LocationHistory::countRaw(qint64 fromMs, qint64 toMs) const
+{
+    // Whole cold blocks overlapping the window; close enough for a budget
+    int count = 0;
+    for (const GorillaBlock& block : m_cold) {
+        if (block.lastTimestamp() >= fromMs && block.firstTimestamp() <= toMs) {
+            count += block.size();
+        }
+    }
+    return count + m_hot.size() - m_hot.lowerBound(fromMs);
+}
+
+void LocationHistory::windowPoints(int column, qint64 fromMs, qint64 toMs, int maxPoints, QList<QPointF>& points) const
+{
+    const bool rawCovers = !isEmpty()
+                           && (firstRawTimestamp() <= fromMs || firstRawTimestamp() <= firstTimestamp());
+    if (!rawCovers || countRaw(fromMs, toMs) > maxPoints) {
+        m_summaries.toPoints(column, fromMs, toMs, maxPoints, points);
+        return;
+    }
+
+    // Common case: the hot ring alone covers the window
+    if (m_cold.isEmpty() || m_hot.firstTimestamp() <= fromMs) {
+        m_hot.toPoints(column, points, m_hot.lowerBound(fromMs));
+        return;
+    }
+
+    points.clear();
+    forEachSample(fromMs, toMs, [&points, column](const PowerSample& sample) {
+        points.append(QPointF(sample.timestampMs, sample.values[column]));
+    });
+}
+
+void LocationHistory::forEachSample(qint64 fromMs, qint64 toMs, const Visitor& visitor) const
+{
+    PowerSample sample;
+    for (const GorillaBlock& block : m_cold) {
+        if (block.lastTimestamp() < fromMs || block.firstTimestamp() > toMs)
+            continue;
+
+        GorillaBlock::Decoder decoder(block);
+        while (decoder.next(sample)) {
+            if (sample.timestampMs >= fromMs && sample.timestampMs <= toMs) {
+                visitor(sample);
+            }
+        }
+    }
+
+    for (int index = m_hot.lowerBound(fromMs); index < m_hot.size(); ++index) {
+        sample.timestampMs = m_hot.timestampAt(index);
+        if (sample.timestampMs > toMs)
+            break;
+        for (int column = 0; column < SampleRingBuffer::ColumnCount; ++column) {
+            sample.values[column] = m_hot.valueAt(column, index);
+        }
+        visitor(sample);
+    }
+}
+
+void LocationHistory::applyRetention(qint64 newestMs)
+{
+    // Cheap in the steady state: at most one comparison per tier
+    const qint64 cutoff = newestMs - m_retentionMs;
+    if (!m_cold.isEmpty() && m_cold.first().lastTimestamp() < cutoff) {
+        dropColdBefore(cutoff);
+    }
+    if (!m_hot.isEmpty() && m_hot.firstTimestamp() < cutoff) {
+        m_hot.dropBefore(cutoff);
+    }
+    if (!m_summaries.isEmpty() && m_summaries.firstTimestamp() < cutoff) {
+        m_summaries.dropBefore(cutoff);
+    }
+}
+
+void LocationHistory::dropColdBefore(qint64 timestampMs)
+{
+    // Whole blocks only; a block straddling the cutoff is kept
+    int dropped = 0;
+    qint64 sealedBytes = 0;
+    while (dropped < m_cold.size() && m_cold[dropped].lastTimestamp() < timestampMs) {
+        // The open last block was never charged
+        if (dropped < m_cold.size() - 1) {
+            sealedBytes += m_cold[dropped].memoryUsage();
+        }
+        ++dropped;
+    }
+    m_cold.remove(0, dropped);
+    MemoryBudget::instance()->refund(sealedBytes);
+}
+
+void LocationHistory::dropRawBefore(qint64 timestampMs)
+{
+    dropColdBefore(timestampMs);
+
+    // Never below the newest sample; the charts always need one raw point
+    m_hot.dropOldest(qMin(m_hot.lowerBound(timestampMs), m_hot.size() - 1));
+    fitHotCapacity();
+}
+
+void LocationHistory::dropBefore(qint64 timestampMs)
+{
+    dropRawBefore(timestampMs);
+    m_summaries.dropBefore(timestampMs);
+}
+
+void LocationHistory::fitHotCapacity()
+{
+    // Halve while the samples would still fit twice over
+    int capacity = m_hot.capacity();
+    while (capacity / 2 >= qMax(MIN_HOT_CAPACITY, 2 * m_hot.size())) {
+        capacity /= 2;
+    }
+    if (capacity != m_hot.capacity()) {
+        m_hot.setCapacity(capacity);
+    }
+}
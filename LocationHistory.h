@@ -0,0 +1,85 @@
+// LocationHistory.h
+#ifndef LOCATIONHISTORY_H
+#define LOCATIONHISTORY_H
+
+#include <QString>
+#include <QList>
+#include <QPointF>
+#include <QVector>
+#include <functional>
+#include "PowerSample.h"
+#include "SampleRingBuffer.h"
+#include "GorillaBlock.h"
+#include "LodPyramid.h"
+
+// Everything retained for one location, in three tiers:
+//   hot   the newest samples, raw, in a ring buffer
+//   cold  older samples at full resolution in Gorilla-compressed blocks
+//   lod   min/max summaries for windows too long to plot sample by sample
+// Retention is a time window, not a sample count, so it means the same for a
+// 1 Hz and a 50 Hz meter. Samples leaving the hot ring are compressed into the
+// cold tier as long as they are inside the window. Under pressure MemoryBudget
+// first drops old full-resolution samples (their span stays visible,
+// downsampled, through the summaries) and then old data altogether.
+class LocationHistory
+{
+public:
+    using Visitor = std::function<void(const PowerSample&)>;
+
+    static constexpr qint64 DEFAULT_RETENTION_MS = qint64(3) * 24 * 60 * 60 * 1000;
+
+    explicit LocationHistory(const QString& name, qint64 retentionMs = DEFAULT_RETENTION_MS);
+    ~LocationHistory();
+
+    LocationHistory(const LocationHistory&) = delete;
+    LocationHistory& operator=(const LocationHistory&) = delete;
+
+    QString name() const { return m_name; }
+
+    void setRetention(qint64 retentionMs);
+    qint64 retention() const { return m_retentionMs; }
+
+    void append(const PowerSample& sample);
+
+    bool isEmpty() const { return m_hot.isEmpty(); }
+    // Oldest data still retained, in any tier; only valid when !isEmpty()
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const { return m_hot.lastTimestamp(); }
+    // Oldest sample still kept at full resolution
+    qint64 firstRawTimestamp() const;
+
+    // Points of one column over [fromMs, toMs], at most about maxPoints:
+    // full-resolution samples while they reach back far enough and fit the
+    // budget, min/max decimated summaries otherwise
+    void windowPoints(int column, qint64 fromMs, qint64 toMs, int maxPoints, QList<QPointF>& points) const;
+
+    // Visits every full-resolution sample in [fromMs, toMs], oldest first,
+    // decompressing cold blocks on the fly
+    void forEachSample(qint64 fromMs, qint64 toMs, const Visitor& visitor) const;
+
+    qint64 memoryUsage() const;
+
+    // Used by MemoryBudget under pressure
+    void dropRawBefore(qint64 timestampMs);
+    void dropBefore(qint64 timestampMs);
+
+private:
+    static constexpr int MIN_HOT_CAPACITY = 1024;
+    static constexpr int MAX_HOT_CAPACITY = 4096;
+    static constexpr int COLD_BLOCK_SAMPLES = 1024;
+
+    void applyRetention(qint64 newestMs);
+    void spillOldest();
+    void dropColdBefore(qint64 timestampMs);
+    // Full-resolution samples in [fromMs, toMs], without decoding anything
+    int countRaw(qint64 fromMs, qint64 toMs) const;
+    void fitHotCapacity();
+
+    QString m_name;
+    qint64 m_retentionMs;
+    SampleRingBuffer m_hot;
+    QVector<GorillaBlock> m_cold;   // oldest first; the last one is still open
+    LodPyramid m_summaries;
+};
+
+#endif // LOCATIONHISTORY_H
@@ -0,0 +1,95 @@
+// LocationOverviewDelegate.cpp
+#include "LocationOverviewDelegate.h"
+#include "LocationTableModel.h"
+#include "mainwindow.h"
+#include <QPainter>
+
+LocationOverviewDelegate::LocationOverviewDelegate(QObject* parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void LocationOverviewDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option,
+                                     const QModelIndex& index) const
+{
+    painter->save();
+
+    const bool selected = option.state & QStyle::State_Selected;
+    if (selected) {
+        painter->fillRect(option.rect, option.palette.highlight());
+    }
+
+    const QRect area = option.rect.adjusted(6, 0, -6, 0);
+    const QColor color = index.data(LocationTableModel::LocationColorRole).value<QColor>();
+
+    if (index.column() == LocationTableModel::TrendColumn) {
+        paintTrend(painter, QRectF(area.adjusted(0, 4, 0, -4)), index);
+        painter->restore();
+        return;
+    }
+
+    QRect textArea = area;
+    if (index.column() == LocationTableModel::NameColumn) {
+        // Same colour as the location's chart series
+        const QRect swatch(area.left(), area.center().y() - 5, 10, 10);
+        painter->fillRect(swatch, color);
+        textArea.setLeft(swatch.right() + 8);
+    }
+
+    painter->setPen(option.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+    const QString text = option.fontMetrics.elidedText(index.data().toString(), Qt::ElideRight, textArea.width());
+    painter->drawText(textArea, index.data(Qt::TextAlignmentRole).toInt(), text);
+
+    painter->restore();
+}
+
+void LocationOverviewDelegate::paintTrend(QPainter* painter, const QRectF& area, const QModelIndex& index) const
+{
+    const LocationTableModel* model = qobject_cast<const LocationTableModel*>(index.model());
+    const LocationStats* location = model ? model->location(index.row()) : nullptr;
+    if (!location || location->isEmpty() || area.width() < 2)
+        return;
+
+    // Same channel as the power chart's aggregate series, about two points per pixel
+    const int channel = ChannelSchema::aggregateChannel(ChannelSchema::Power);
+    const qint64 toMs = location->lastTimestamp();
+    const qint64 fromMs = toMs - TREND_WINDOW_MS;
+    location->history.windowPoints(channel, fromMs, toMs, qMax(2, 2 * int(area.width())), m_points);
+    if (m_points.size() < 2)
+        return;
+
+    double minValue = m_points.first().y();
+    double maxValue = minValue;
+    for (const QPointF& point : m_points) {
+        minValue = qMin(minValue, point.y());
+        maxValue = qMax(maxValue, point.y());
+    }
+    // A flat line is drawn through the middle
+    if (maxValue - minValue < 1e-6) {
+        minValue -= 1;
+        maxValue += 1;
+    }
+
+    const double xScale = area.width() / double(TREND_WINDOW_MS);
+    const double yScale = area.height() / (maxValue - minValue);
+    m_polyline.resize(m_points.size());
+    for (int i = 0; i < m_points.size(); ++i) {
+        m_polyline[i] = QPointF(area.left() + (m_points[i].x() - fromMs) * xScale,
+                                area.bottom() - (m_points[i].y() - minValue) * yScale);
+    }
+
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(QPen(index.data(LocationTableModel::LocationColorRole).value<QColor>(), 1.5));
+    painter->drawPolyline(m_polyline);
+}
+
+QSize LocationOverviewDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const
+{
+    // Fixed row height, so the view never has to measure rows it doesn't show
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    if (index.column() == LocationTableModel::TrendColumn) {
+        size.setWidth(qMax(size.width(), 160));
+    }
+    size.setHeight(ROW_HEIGHT);
+    return size;
+}
@@ -0,0 +1,37 @@
+// LocationOverviewDelegate.h
+#ifndef LOCATIONOVERVIEWDELEGATE_H
+#define LOCATIONOVERVIEWDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QList>
+#include <QPointF>
+#include <QPolygonF>
+
+// Paints the rows of a LocationTableModel: a colour swatch and the name, the
+// live values as plain text and, in the trend column, a sparkline of the
+// location's aggregate power over the last few minutes. The sparkline is read
+// straight from the location's history when a row is painted, so rows
+// scrolled out of view cost nothing.
+class LocationOverviewDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    static const int ROW_HEIGHT = 28;
+
+    explicit LocationOverviewDelegate(QObject* parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+private:
+    static constexpr qint64 TREND_WINDOW_MS = qint64(10) * 60 * 1000;
+
+    void paintTrend(QPainter* painter, const QRectF& area, const QModelIndex& index) const;
+
+    // Scratch buffers reused across rows so painting doesn't reallocate
+    mutable QList<QPointF> m_points;
+    mutable QPolygonF m_polyline;
+};
+
+#endif // LOCATIONOVERVIEWDELEGATE_H
@@ -0,0 +1,122 @@
+// LocationTableModel.cpp
+#include "LocationTableModel.h"
+#include "mainwindow.h"
+#include <QLocale>
+
+LocationTableModel::LocationTableModel(QObject* parent)
+    : QAbstractTableModel(parent),
+    m_firstChangedRow(0),
+    m_lastChangedRow(-1)
+{
+}
+
+void LocationTableModel::setLocations(const QVector<LocationStats*>& locations)
+{
+    beginResetModel();
+    m_locations = locations;
+    m_firstChangedRow = 0;
+    m_lastChangedRow = -1;
+    endResetModel();
+}
+
+void LocationTableModel::markRowChanged(int row)
+{
+    if (m_firstChangedRow > m_lastChangedRow) {
+        m_firstChangedRow = m_lastChangedRow = row;
+        return;
+    }
+    m_firstChangedRow = qMin(m_firstChangedRow, row);
+    m_lastChangedRow = qMax(m_lastChangedRow, row);
+}
+
+void LocationTableModel::markAllRowsChanged()
+{
+    m_firstChangedRow = 0;
+    m_lastChangedRow = m_locations.size() - 1;
+}
+
+void LocationTableModel::flushChanges()
+{
+    if (m_firstChangedRow > m_lastChangedRow)
+        return;
+
+    // One signal for the whole range; the view only repaints the rows it shows
+    emit dataChanged(index(m_firstChangedRow, FirstValueColumn), index(m_lastChangedRow, TrendColumn),
+                     {Qt::DisplayRole});
+    m_firstChangedRow = 0;
+    m_lastChangedRow = -1;
+}
+
+void LocationTableModel::updateMemoryUsage()
+{
+    if (m_locations.isEmpty())
+        return;
+
+    emit dataChanged(index(0, MemoryColumn), index(m_locations.size() - 1, MemoryColumn),
+                     {Qt::DisplayRole});
+}
+
+int LocationTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_locations.size();
+}
+
+int LocationTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant LocationTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_locations.size())
+        return QVariant();
+
+    const LocationStats* location = m_locations[index.row()];
+    const int column = index.column();
+
+    if (role == LocationColorRole)
+        return location->color;
+
+    if (role == Qt::TextAlignmentRole) {
+        if (column == NameColumn)
+            return int(Qt::AlignLeft | Qt::AlignVCenter);
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (column == NameColumn)
+        return location->name;
+
+    if (column >= FirstValueColumn && column < TrendColumn) {
+        if (location->isEmpty())
+            return QString("-");
+        const ChannelSchema::Quantity quantity = ChannelSchema::TableQuantities[column - FirstValueColumn];
+        const double total = ChannelSchema::quantityTotal(quantity, location->lastSample.values);
+        return QString("%1 %2").arg(QString::number(total, 'f', 1),
+                                    QString::fromLatin1(ChannelSchema::Quantities[quantity].unit));
+    }
+
+    if (column == MemoryColumn)
+        return QLocale().formattedDataSize(location->history.memoryUsage());
+
+    // The trend column is drawn straight from the history by the delegate
+    return QVariant();
+}
+
+QVariant LocationTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    if (section == NameColumn)
+        return QString("Location");
+    if (section >= FirstValueColumn && section < TrendColumn)
+        return ChannelSchema::totalHeader(ChannelSchema::TableQuantities[section - FirstValueColumn]);
+    if (section == TrendColumn)
+        return QString("Trend");
+    if (section == MemoryColumn)
+        return QString("History");
+    return QVariant();
+}
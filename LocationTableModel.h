@@ -0,0 +1,62 @@
+// LocationTableModel.h
+#ifndef LOCATIONTABLEMODEL_H
+#define LOCATIONTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "ChannelSchema.h"
+
+class LocationStats;
+
+// Overview of a cluster's locations, one row each: name, the latest total of
+// every ChannelSchema::TableQuantities group, a trend column drawn by
+// LocationOverviewDelegate and the memory held by the location's history.
+// Rows are only views of the LocationStats; incoming samples just mark rows
+// changed, and flushChanges() reports them to the view in one dataChanged()
+// per frame however many samples arrived.
+class LocationTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int ValueColumnCount =
+        sizeof(ChannelSchema::TableQuantities) / sizeof(ChannelSchema::TableQuantities[0]);
+
+    enum Column {
+        NameColumn = 0,
+        FirstValueColumn = 1,
+        TrendColumn = FirstValueColumn + ValueColumnCount,
+        MemoryColumn,
+        ColumnCount
+    };
+
+    enum Role {
+        // QColor of the location, for the name swatch and the trend line
+        LocationColorRole = Qt::UserRole + 1
+    };
+
+    explicit LocationTableModel(QObject* parent = nullptr);
+
+    void setLocations(const QVector<LocationStats*>& locations);
+    LocationStats* location(int row) const { return m_locations.value(row); }
+
+    // Cheap enough to call per sample; nothing is emitted until flushChanges()
+    void markRowChanged(int row);
+    void markAllRowsChanged();
+    void flushChanges();
+    // Memory use changes on the budget's own clock, not per sample
+    void updateMemoryUsage();
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    QVector<LocationStats*> m_locations;
+    // Range of rows changed since the last flush; empty when first > last
+    int m_firstChangedRow;
+    int m_lastChangedRow;
+};
+
+#endif // LOCATIONTABLEMODEL_H
@@ -0,0 +1,195 @@
+// LodPyramid.cpp
+#include "LodPyramid.h"
+
+LodPyramid::LodPyramid(int levels, int fanout, int bucketsPerLevel)
+{
+    m_levels.resize(qMax(1, levels));
+
+    qint64 samplesPerBucket = 1;
+    for (Level& level : m_levels) {
+        samplesPerBucket *= qMax(2, fanout);
+        level.samplesPerBucket = samplesPerBucket;
+        level.maxBuckets = qMax(1, bucketsPerLevel);
+        level.ring.resize(qMin(INITIAL_BUCKETS, level.maxBuckets));
+    }
+}
+
+void LodPyramid::append(const PowerSample& sample)
+{
+    for (Level& level : m_levels) {
+        Bucket& open = level.open;
+
+        // A new extreme is the latest sample, so it comes after the other one
+        if (level.openSamples == 0) {
+            open.startMs = sample.timestampMs;
+            open.minFirst = ~0u;
+            for (int column = 0; column < ChannelSchema::ChannelCount; ++column) {
+                open.min[column] = open.max[column] = sample.values[column];
+            }
+        } else {
+            for (int column = 0; column < ChannelSchema::ChannelCount; ++column) {
+                const float value = sample.values[column];
+                if (value < open.min[column]) {
+                    open.min[column] = value;
+                    open.minFirst &= ~(1u << column);
+                } else if (value > open.max[column]) {
+                    open.max[column] = value;
+                    open.minFirst |= 1u << column;
+                }
+            }
+        }
+        open.endMs = sample.timestampMs;
+
+        if (++level.openSamples == level.samplesPerBucket) {
+            closeBucket(level);
+        }
+    }
+}
+
+void LodPyramid::closeBucket(Level& level)
+{
+    // Ring of closed buckets; grows up to maxBuckets, then the oldest bucket
+    // is overwritten
+    if (level.size == level.ring.size() && level.ring.size() < level.maxBuckets) {
+        resizeRing(level, qMin(2 * level.ring.size(), level.maxBuckets));
+    }
+
+    const int capacity = level.ring.size();
+    int slot;
+    if (level.size < capacity) {
+        slot = level.head + level.size;
+        if (slot >= capacity)
+            slot -= capacity;
+        ++level.size;
+    } else {
+        slot = level.head;
+        level.head = (level.head + 1 == capacity) ? 0 : level.head + 1;
+        level.truncated = true;
+    }
+
+    level.ring[slot] = level.open;
+    level.openSamples = 0;
+}
+
+void LodPyramid::resizeRing(Level& level, int buckets)
+{
+    QVector<Bucket> ring(buckets);
+    for (int i = 0; i < level.size; ++i) {
+        ring[i] = level.at(i);
+    }
+    level.ring.swap(ring);
+    level.head = 0;
+}
+
+void LodPyramid::clear()
+{
+    for (Level& level : m_levels) {
+        level.head = 0;
+        level.size = 0;
+        level.openSamples = 0;
+        level.truncated = false;
+        level.ring.resize(qMin(INITIAL_BUCKETS, level.maxBuckets));
+        level.ring.squeeze();
+    }
+}
+
+void LodPyramid::dropBefore(qint64 timestampMs)
+{
+    for (Level& level : m_levels) {
+        int dropped = 0;
+        while (dropped < level.size && level.at(dropped).endMs < timestampMs) {
+            ++dropped;
+        }
+        if (dropped == 0)
+            continue;
+
+        level.head = (level.head + dropped) % level.ring.size();
+        level.size -= dropped;
+        level.truncated = true;
+
+        // Give memory back once the ring is mostly empty
+        int buckets = level.ring.size();
+        while (buckets / 2 >= qMax(INITIAL_BUCKETS, 2 * level.size)) {
+            buckets /= 2;
+        }
+        if (buckets != level.ring.size()) {
+            resizeRing(level, buckets);
+        }
+    }
+}
+
+qint64 LodPyramid::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (const Level& level : m_levels) {
+        bytes += qint64(level.ring.size()) * sizeof(Bucket);
+    }
+    return bytes;
+}
+
+qint64 LodPyramid::firstTimestamp() const
+{
+    // The coarsest level reaches back furthest
+    return m_levels.last().bucket(0).startMs;
+}
+
+void LodPyramid::bucketRange(const Level& level, qint64 fromMs, qint64 toMs, int& first, int& last)
+{
+    // Buckets are in time order, so both ends are binary searches
+    int low = 0;
+    int high = level.bucketCount();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (level.bucket(middle).endMs < fromMs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    first = low;
+
+    high = level.bucketCount();
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (level.bucket(middle).startMs <= toMs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    last = low;
+}
+
+void LodPyramid::toPoints(int column, qint64 fromMs, qint64 toMs, int maxPoints, QList<QPointF>& points) const
+{
+    if (isEmpty()) {
+        points.clear();
+        return;
+    }
+
+    // Finest level that still reaches back to fromMs and fits the point budget
+    const Level* chosen = &m_levels.last();
+    int first = 0;
+    int last = 0;
+    for (const Level& level : m_levels) {
+        if (level.bucketCount() == 0)
+            continue;
+        if (!level.holdsEverything() && level.bucket(0).startMs > fromMs)
+            continue;
+
+        bucketRange(level, fromMs, toMs, first, last);
+        if (2 * (last - first) <= maxPoints) {
+            chosen = &level;
+            break;
+        }
+    }
+    bucketRange(*chosen, fromMs, toMs, first, last);
+
+    // Two points per bucket: its extremes, in the order they occurred
+    points.resize(2 * (last - first));
+    const quint32 columnBit = 1u << column;
+    for (int i = first, point = 0; i < last; ++i, point += 2) {
+        const Bucket& bucket = chosen->bucket(i);
+        const bool minFirst = bucket.minFirst & columnBit;
+        points[point] = QPointF(bucket.startMs, minFirst ? bucket.min[column] : bucket.max[column]);
+        points[point + 1] = QPointF(bucket.endMs, minFirst ? bucket.max[column] : bucket.min[column]);
+    }
+}
@@ -0,0 +1,81 @@
+// LodPyramid.h
+#ifndef LODPYRAMID_H
+#define LODPYRAMID_H
+
+#include <QVector>
+#include <QList>
+#include <QPointF>
+#include "PowerSample.h"
+
+// Level-of-detail summaries of one location's samples, for chart windows too
+// long to plot raw. Level k keeps fixed-size buckets of fanout^k consecutive
+// samples with the min and max of every channel, so any window can be drawn
+// from the finest level that needs about two points per pixel. Every level is
+// updated on append (O(levels * channels)) and keeps its own ring of buckets;
+// coarser levels therefore reach further back in time. Rings start small and
+// grow up to bucketsPerLevel, and shrink again when old buckets are dropped.
+class LodPyramid
+{
+public:
+    LodPyramid(int levels = 4, int fanout = 8, int bucketsPerLevel = 1024);
+
+    void append(const PowerSample& sample);
+    void clear();
+    // Drop every closed bucket that ends before timestampMs
+    void dropBefore(qint64 timestampMs);
+    qint64 memoryUsage() const;
+
+    bool isEmpty() const { return m_levels.last().bucketCount() == 0; }
+    // Oldest timestamp still summarised by any level; only valid when !isEmpty()
+    qint64 firstTimestamp() const;
+
+    // Min/max decimation of one column over [fromMs, toMs]: two points per
+    // bucket, in time order, from the finest level that covers the window in
+    // at most maxPoints points (or the coarsest level if none does).
+    void toPoints(int column, qint64 fromMs, qint64 toMs, int maxPoints, QList<QPointF>& points) const;
+
+private:
+    struct Bucket {
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        float min[ChannelSchema::ChannelCount];
+        float max[ChannelSchema::ChannelCount];
+        // Bit per column: the minimum occurred before the maximum
+        quint32 minFirst = 0;
+    };
+
+    struct Level {
+        qint64 samplesPerBucket = 1;
+        int maxBuckets = 1;
+        QVector<Bucket> ring;
+        int head = 0;   // physical slot of the oldest closed bucket
+        int size = 0;
+        bool truncated = false;   // buckets were overwritten or dropped
+
+        // Bucket still being filled; its minFirst is kept current, so the
+        // newest span draws in the right order before the bucket closes
+        Bucket open;
+        qint64 openSamples = 0;
+
+        const Bucket& at(int index) const
+        {
+            int physical = head + index;
+            return ring[physical >= ring.size() ? physical - ring.size() : physical];
+        }
+        int bucketCount() const { return size + (openSamples > 0 ? 1 : 0); }
+        const Bucket& bucket(int index) const { return index < size ? at(index) : open; }
+        bool holdsEverything() const { return !truncated; }
+    };
+
+    static constexpr int INITIAL_BUCKETS = 16;
+
+    void closeBucket(Level& level);
+    // Reallocates a level's ring, keeping its closed buckets in order
+    static void resizeRing(Level& level, int buckets);
+    // Buckets [first, last) of a level that overlap [fromMs, toMs]
+    static void bucketRange(const Level& level, qint64 fromMs, qint64 toMs, int& first, int& last);
+
+    QVector<Level> m_levels;
+};
+
+#endif // LODPYRAMID_H
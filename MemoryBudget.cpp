@@ -0,0 +1,139 @@
+// MemoryBudget.cpp
+#include "MemoryBudget.h"
+#include "LocationHistory.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+MemoryBudget* MemoryBudget::instance()
+{
+    // Owned by the application so it goes away with the GUI thread
+    static MemoryBudget* budget = new MemoryBudget(QCoreApplication::instance());
+    return budget;
+}
+
+MemoryBudget::MemoryBudget(QObject* parent)
+    : QObject(parent),
+    m_budget(DEFAULT_BUDGET)
+{
+    m_timer.setInterval(CHECK_INTERVAL_MS);
+    connect(&m_timer, &QTimer::timeout, this, &MemoryBudget::enforce);
+    m_timer.start();
+}
+
+void MemoryBudget::setBudget(qint64 bytes)
+{
+    m_budget = qMax<qint64>(0, bytes);
+    enforce();
+}
+
+void MemoryBudget::registerHistory(LocationHistory* history)
+{
+    m_histories.append(history);
+    m_usage += history->memoryUsage();
+}
+
+void MemoryBudget::unregisterHistory(LocationHistory* history)
+{
+    m_histories.removeAll(history);
+    m_usage = measure();
+}
+
+bool MemoryBudget::requestGrowth(qint64 bytes)
+{
+    if (m_usage + bytes > m_budget)
+        return false;
+
+    m_usage += bytes;
+    return true;
+}
+
+void MemoryBudget::charge(qint64 bytes)
+{
+    m_usage += bytes;
+
+    // Not from in here: the caller is in the middle of appending
+    if (m_usage > m_budget && !m_checkPending) {
+        m_checkPending = true;
+        QTimer::singleShot(0, this, &MemoryBudget::enforce);
+    }
+}
+
+void MemoryBudget::refund(qint64 bytes)
+{
+    m_usage = qMax<qint64>(0, m_usage - bytes);
+}
+
+QVector<MemoryBudget::Usage> MemoryBudget::report() const
+{
+    QVector<Usage> usage;
+    usage.reserve(m_histories.size());
+    for (const LocationHistory* history : m_histories) {
+        usage.append({history->name(), history->memoryUsage()});
+    }
+    return usage;
+}
+
+qint64 MemoryBudget::measure() const
+{
+    qint64 bytes = 0;
+    for (const LocationHistory* history : m_histories) {
+        bytes += history->memoryUsage();
+    }
+    return bytes;
+}
+
+void MemoryBudget::enforce()
+{
+    m_checkPending = false;
+    m_usage = measure();
+
+    if (m_usage > m_budget) {
+        const qint64 before = m_usage;
+
+        // Downsampling first: old raw samples stay visible through the summaries
+        release(true, MIN_RAW_SPAN_MS);
+        if (m_usage > m_budget) {
+            release(false, MIN_SPAN_MS);
+        }
+
+        qDebug() << "Memory budget exceeded, released" << (before - m_usage) << "bytes;"
+                 << m_usage << "of" << m_budget << "in use";
+    }
+
+    emit usageUpdated();
+}
+
+void MemoryBudget::release(bool rawOnly, qint64 minSpanMs)
+{
+    for (int step = 0; step < 16 && m_usage > m_budget; ++step) {
+        // Oldest and newest data over all locations
+        bool any = false;
+        qint64 oldest = 0;
+        qint64 newest = 0;
+        for (const LocationHistory* history : m_histories) {
+            if (history->isEmpty())
+                continue;
+            const qint64 first = rawOnly ? history->firstRawTimestamp() : history->firstTimestamp();
+            oldest = any ? qMin(oldest, first) : first;
+            newest = any ? qMax(newest, history->lastTimestamp()) : history->lastTimestamp();
+            any = true;
+        }
+
+        const qint64 limit = newest - minSpanMs;
+        if (!any || oldest >= limit)
+            return;
+
+        // The oldest data goes first, whichever location it belongs to
+        const qint64 cutoff = qMin(limit, oldest + qMax<qint64>(1, (newest - oldest) / 4));
+        for (LocationHistory* history : m_histories) {
+            if (history->isEmpty())
+                continue;
+            if (rawOnly)
+                history->dropRawBefore(cutoff);
+            else
+                history->dropBefore(cutoff);
+        }
+
+        m_usage = measure();
+    }
+}
@@ -0,0 +1,74 @@
+// MemoryBudget.h
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QString>
+
+class LocationHistory;
+
+// Process-wide cap on retained sample history. Every LocationHistory
+// registers here, asks before growing its hot ring and charges every cold
+// block it seals; once a second the budget recomputes actual usage and, if
+// it is over, releases the oldest data across all locations: first raw
+// samples (downsampling them to their LOD summaries), then summaries too.
+// Per-location usage is published for display.
+class MemoryBudget : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Usage {
+        QString name;
+        qint64 bytes;
+    };
+
+    static MemoryBudget* instance();
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+    // As of the last check, plus growth granted since
+    qint64 usage() const { return m_usage; }
+    QVector<Usage> report() const;
+
+    void registerHistory(LocationHistory* history);
+    void unregisterHistory(LocationHistory* history);
+
+    // Accounts the bytes and returns true if they fit in the budget
+    bool requestGrowth(qint64 bytes);
+    // Accounts bytes that are kept whether they fit or not, like sealed cold
+    // blocks; going over the budget triggers a check right away
+    void charge(qint64 bytes);
+    // Gives back bytes granted or charged before
+    void refund(qint64 bytes);
+
+signals:
+    void usageUpdated();
+
+private slots:
+    void enforce();
+
+private:
+    explicit MemoryBudget(QObject* parent = nullptr);
+
+    static const qint64 DEFAULT_BUDGET = qint64(256) * 1024 * 1024;
+    static const int CHECK_INTERVAL_MS = 1000;
+    // Never release the most recent data, whatever the pressure
+    static const qint64 MIN_RAW_SPAN_MS = qint64(10) * 60 * 1000;
+    static const qint64 MIN_SPAN_MS = qint64(60) * 60 * 1000;
+
+    qint64 measure() const;
+    // Releases the oldest quarter of the retained span, step by step, until
+    // usage fits or only minSpanMs is left; rawOnly keeps the summaries
+    void release(bool rawOnly, qint64 minSpanMs);
+
+    QVector<LocationHistory*> m_histories;
+    QTimer m_timer;
+    qint64 m_budget;
+    qint64 m_usage = 0;
+    bool m_checkPending = false;
+};
+
+#endif // MEMORYBUDGET_H
@@ -1,6 +1,8 @@
 // ModernGaugeWidget.cpp
 #include "ModernGaugeWidget.h"
+#include "GaugeAnimator.h"
 #include <QPainter>
+#include <QResizeEvent>
 #include <QtMath>
 #include <QRandomGenerator>
 #include <QtWebSockets/QWebSocket>
@@ -16,23 +18,31 @@ ModernGaugeWidget::ModernGaugeWidget(const QString &title, const QString &label,
     m_value(minValue),
     m_color(color),
     m_targetValue(minValue),
-    m_animationStep(0)
+    m_startValue(minValue),
+    m_animationElapsedMs(0)
 {
     // Dark theme
     setStyleSheet("background-color: #0F0F0F; color: #CCCCCC;");
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMinimumSize(180, 180);
+}
 
-    // Animation timer
-    m_timer = new QTimer(this);
-    connect(m_timer, &QTimer::timeout, this, &ModernGaugeWidget::updateAnimation);
-    m_timer->start(30);
+ModernGaugeWidget::~ModernGaugeWidget()
+{
+    GaugeAnimator::instance()->remove(this);
 }
 
 void ModernGaugeWidget::setValue(double value)
 {
-    m_targetValue = qBound(m_minValue, value, m_maxValue);
-    m_animationStep = (m_targetValue - m_value) / 20.0;
+    const double target = qBound(m_minValue, value, m_maxValue);
+    if (target == m_targetValue && m_value == m_targetValue)
+        return;
+
+    // Every new target restarts the sweep from wherever the needle is now
+    m_startValue = m_value;
+    m_targetValue = target;
+    m_animationElapsedMs = 0;
+    GaugeAnimator::instance()->animate(this);
 }
 
 // void ModernGaugeWidget::setRandomValue()
@@ -57,43 +67,57 @@ QString ModernGaugeWidget::getLabelText() const
     }
 }
 
-void ModernGaugeWidget::updateAnimation()
+bool ModernGaugeWidget::advanceAnimation(qint64 elapsedMs)
 {
-    if (qAbs(m_value - m_targetValue) > qAbs(m_animationStep * 0.5)) {
-        m_value += m_animationStep;
-        update();
-    } else {
-        m_value = m_targetValue;
-    }
+    // Linear in time, so the sweep takes as long at any tick rate
+    m_animationElapsedMs += elapsedMs;
+    const double progress = qMin(1.0, double(m_animationElapsedMs) / ANIMATION_DURATION_MS);
+    m_value = m_startValue + (m_targetValue - m_startValue) * progress;
+    update();
+
+    return progress < 1.0;
 }
 
-void ModernGaugeWidget::paintEvent(QPaintEvent *event)
+void ModernGaugeWidget::resizeEvent(QResizeEvent *event)
 {
-    Q_UNUSED(event);
+    QFrame::resizeEvent(event);
 
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);
+    // Re-rendered lazily by the next paintEvent
+    m_backgroundLayer = QPixmap();
+    m_overlayLayer = QPixmap();
+}
 
+void ModernGaugeWidget::renderStaticLayers(qreal devicePixelRatio)
+{
     int width = this->width();
     int height = this->height();
     int centerX = width / 2;
     int centerY = height / 2;
     int radius = qMin(width, height) / 2 - 10;
+    m_radius = radius;
+
+    // Layers are rendered at device resolution so they stay sharp on HiDPI screens
+    m_backgroundLayer = QPixmap(size() * devicePixelRatio);
+    m_backgroundLayer.setDevicePixelRatio(devicePixelRatio);
+    m_overlayLayer = QPixmap(size() * devicePixelRatio);
+    m_overlayLayer.setDevicePixelRatio(devicePixelRatio);
+    m_overlayLayer.fill(Qt::transparent);
+
+    QPainter background(&m_backgroundLayer);
+    background.setRenderHint(QPainter::Antialiasing);
 
     // Draw black background
-    painter.fillRect(rect(), QColor("#0F0F0F"));
+    background.fillRect(rect(), QColor("#0F0F0F"));
 
     // Draw arc background (dark gray)
-    painter.setPen(QPen(QColor("#333333"), 8, Qt::SolidLine, Qt::RoundCap));
-    painter.drawArc(centerX - radius, centerY - radius, radius * 2, radius * 2, 225 * 16, 270 * 16);
+    background.setPen(QPen(QColor("#333333"), 8, Qt::SolidLine, Qt::RoundCap));
+    background.drawArc(centerX - radius, centerY - radius, radius * 2, radius * 2, 225 * 16, 270 * 16);
 
-    // Draw value arc
-    double normalized = (m_value - m_minValue) / (m_maxValue - m_minValue);
-    painter.setPen(QPen(m_color, 8, Qt::SolidLine, Qt::RoundCap));
-    painter.drawArc(centerX - radius, centerY - radius, radius * 2, radius * 2, 225 * 16, normalized * 270 * 16);
+    QPainter overlay(&m_overlayLayer);
+    overlay.setRenderHint(QPainter::Antialiasing);
 
     // Draw tick marks
-    painter.setPen(QPen(QColor("#666666"), 1));
+    overlay.setPen(QPen(QColor("#666666"), 1));
     for (int i = 0; i <= 27; i++) {
         double angle = 225 + i * 10;
         double radians = angle * M_PI / 180.0;
@@ -105,28 +129,58 @@ void ModernGaugeWidget::paintEvent(QPaintEvent *event)
         int x2 = centerX + outerRadius * qCos(radians);
         int y2 = centerY + outerRadius * qSin(radians);
 
-        painter.drawLine(x1, y1, x2, y2);
+        overlay.drawLine(x1, y1, x2, y2);
+    }
+
+    // Draw title text
+    QFont titleFont("Arial", radius/6);
+    overlay.setFont(titleFont);
+    overlay.setPen(QColor("#999999"));
+    QRectF titleRect(0, centerY + radius/2, width, radius/3);
+    overlay.drawText(titleRect, Qt::AlignCenter, m_title);
+
+    // Fonts of the per-frame texts depend on the size as well
+    m_valueFont = QFont("Arial", radius/3, QFont::Bold);
+    m_labelFont = QFont("Arial", radius/5);
+}
+
+void ModernGaugeWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    // Also re-rendered when the widget moves to a screen with another scale factor
+    const qreal devicePixelRatio = devicePixelRatioF();
+    if (m_backgroundLayer.isNull() || m_backgroundLayer.devicePixelRatio() != devicePixelRatio) {
+        renderStaticLayers(devicePixelRatio);
     }
 
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    int width = this->width();
+    int centerX = width / 2;
+    int centerY = this->height() / 2;
+    int radius = m_radius;
+
+    painter.drawPixmap(0, 0, m_backgroundLayer);
+
+    // Draw value arc
+    double normalized = (m_value - m_minValue) / (m_maxValue - m_minValue);
+    painter.setPen(QPen(m_color, 8, Qt::SolidLine, Qt::RoundCap));
+    painter.drawArc(centerX - radius, centerY - radius, radius * 2, radius * 2, 225 * 16, normalized * 270 * 16);
+
+    painter.drawPixmap(0, 0, m_overlayLayer);
+
     // Draw value text
-    QFont valueFont("Arial", radius/3, QFont::Bold);
-    painter.setFont(valueFont);
+    painter.setFont(m_valueFont);
     painter.setPen(m_color);
     QString valueText = QString::number(m_value, 'f', 1);
     QRectF valueRect(0, centerY - radius/3, width, radius/2);
     painter.drawText(valueRect, Qt::AlignCenter, valueText);
 
     // Draw label text (Low, Medium, High)
-    QFont labelFont("Arial", radius/5);
-    painter.setFont(labelFont);
+    painter.setFont(m_labelFont);
     painter.setPen(m_color);
     QRectF labelRect(0, centerY + radius/6, width, radius/3);
     painter.drawText(labelRect, Qt::AlignCenter, getLabelText());
-
-    // Draw title text
-    QFont titleFont("Arial", radius/6);
-    painter.setFont(titleFont);
-    painter.setPen(QColor("#999999"));
-    QRectF titleRect(0, centerY + radius/2, width, radius/3);
-    painter.drawText(titleRect, Qt::AlignCenter, m_title);
 }
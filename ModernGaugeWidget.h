@@ -3,8 +3,9 @@
 #define MODERNGAUGEWIDGET_H
 
 #include <QFrame>
-#include <QTimer>
 #include <QColor>
+#include <QFont>
+#include <QPixmap>
 
 class ModernGaugeWidget : public QFrame
 {
@@ -13,14 +14,17 @@ class ModernGaugeWidget : public QFrame
 public:
     ModernGaugeWidget(const QString &title, const QString &label, double minValue, double maxValue,
                       const QString &units, const QColor &color, QWidget *parent = nullptr);
+    ~ModernGaugeWidget();
     void setValue(double value);
     void setRandomValue();
 
+    // Moves the value towards its target by the given amount of real time;
+    // called by GaugeAnimator. Returns false once the target is reached.
+    bool advanceAnimation(qint64 elapsedMs);
+
 protected:
     void paintEvent(QPaintEvent *event) override;
-
-private slots:
-    void updateAnimation();
+    void resizeEvent(QResizeEvent *event) override;
 
 private:
     QString m_title;
@@ -31,8 +35,21 @@ private:
     double m_value;
     QColor m_color;
     double m_targetValue;
-    double m_animationStep;
-    QTimer *m_timer;
+    double m_startValue;
+    qint64 m_animationElapsedMs;
+
+    static const int ANIMATION_DURATION_MS = 600;
+
+    // Everything but the value arc and texts only changes with the widget's
+    // size, so it is rendered once into two layers (the ticks sit on top of
+    // the value arc) and blitted every frame
+    QPixmap m_backgroundLayer;
+    QPixmap m_overlayLayer;
+    QFont m_valueFont;
+    QFont m_labelFont;
+    int m_radius = 0;
+
+    void renderStaticLayers(qreal devicePixelRatio);
 
     QString getLabelText() const;
 };
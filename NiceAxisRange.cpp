@@ -0,0 +1,63 @@
+// NiceAxisRange.cpp
+#include "NiceAxisRange.h"
+#include <QtMath>
+
+NiceAxisRange::NiceAxisRange(double minimumSpan)
+    : m_minimumSpan(minimumSpan),
+    m_lower(0),
+    m_upper(minimumSpan),
+    m_valid(false)
+{
+}
+
+double NiceAxisRange::niceCeil(double value)
+{
+    if (value <= 0)
+        return 0;
+
+    const double magnitude = qPow(10.0, qFloor(std::log10(value)));
+    const double fraction = value / magnitude;
+
+    double nice;
+    if (fraction <= 1.0)
+        nice = 1.0;
+    else if (fraction <= 2.0)
+        nice = 2.0;
+    else if (fraction <= 2.5)
+        nice = 2.5;
+    else if (fraction <= 5.0)
+        nice = 5.0;
+    else
+        nice = 10.0;
+    return nice * magnitude;
+}
+
+double NiceAxisRange::snapUpper(double dataMax) const
+{
+    // Keep 10% headroom above the data, and never go below the minimum span
+    return qMax(m_minimumSpan, niceCeil(dataMax * 1.1));
+}
+
+bool NiceAxisRange::update(double dataMin, double dataMax)
+{
+    const double upperCandidate = snapUpper(dataMax);
+    const double lowerCandidate = dataMin < 0 ? -niceCeil(-dataMin * 1.1) : 0.0;
+
+    double upper = m_upper;
+    double lower = m_lower;
+
+    // Grow immediately, but only shrink once the data uses less than half of
+    // the current span; this hysteresis keeps the axis from flapping
+    if (!m_valid || dataMax > m_upper || upperCandidate <= m_upper * 0.5) {
+        upper = upperCandidate;
+    }
+    if (!m_valid || dataMin < m_lower || lowerCandidate >= m_lower * 0.5) {
+        lower = lowerCandidate;
+    }
+
+    const bool changed = !m_valid || upper != m_upper || lower != m_lower;
+    m_upper = upper;
+    m_lower = lower;
+    m_valid = true;
+    return changed;
+}
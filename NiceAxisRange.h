@@ -0,0 +1,31 @@
+// NiceAxisRange.h
+#ifndef NICEAXISRANGE_H
+#define NICEAXISRANGE_H
+
+// Turns a raw data range into a stable axis range. Bounds are snapped to
+// "nice" numbers (1, 2, 2.5, 5 x 10^n) and only change when the data leaves
+// the current range or shrinks well inside it, so the axis doesn't relayout
+// on every small fluctuation.
+class NiceAxisRange
+{
+public:
+    explicit NiceAxisRange(double minimumSpan = 100.0);
+
+    // Returns true when lower()/upper() changed and the axis needs updating
+    bool update(double dataMin, double dataMax);
+
+    double lower() const { return m_lower; }
+    double upper() const { return m_upper; }
+
+    static double niceCeil(double value);
+
+private:
+    double snapUpper(double dataMax) const;
+
+    double m_minimumSpan;
+    double m_lower;
+    double m_upper;
+    bool m_valid;
+};
+
+#endif // NICEAXISRANGE_H
@@ -0,0 +1,417 @@
+// PdfReportEngine.cpp
+#include "PdfReportEngine.h"
+#include "NiceAxisRange.h"
+#include <QDateTime>
+#include <QFile>
+#include <QPainter>
+#include <QPdfWriter>
+#include <QPolygonF>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentMap>
+#include <limits>
+
+// Pages rendered per batch and pool thread; bounds the QPictures held at once
+static const int PAGES_PER_THREAD = 4;
+
+void PdfReportEngine::render(QPromise<Result>& promise, const Report& report)
+{
+    Result result;
+
+    // Device units are those of QPicture, so pictures replay 1:1, fonts included
+    QPdfWriter writer(report.fileName);
+    writer.setPageSize(QPageSize(QPageSize::A4));
+    writer.setPageOrientation(QPageLayout::Landscape);
+    writer.setPageMargins(QMarginsF(15, 15, 15, 15));
+    writer.setResolution(report.dpi);
+    writer.setTitle(report.title);
+
+    QPainter painter;
+    if (!painter.begin(&writer)) {
+        result.error = "Could not open file for writing.";
+        promise.addResult(result);
+        return;
+    }
+
+    const Layout pageLayout = layout(report, QRectF(0, 0, writer.width(), writer.height()));
+    const int pageCount = pageLayout.pages.size();
+    const int batchSize = qMax(1, QThread::idealThreadCount()) * PAGES_PER_THREAD;
+    promise.setProgressRange(0, PROGRESS_STEPS);
+
+    QVector<int> batch;
+    for (int first = 0; first < pageCount; first += batchSize) {
+        if (promise.isCanceled()) {
+            painter.end();
+            QFile::remove(report.fileName);
+            return;
+        }
+
+        batch.clear();
+        for (int page = first; page < qMin(pageCount, first + batchSize); ++page) {
+            batch.append(page);
+        }
+
+        const QList<QPicture> pictures = QtConcurrent::blockingMapped<QList<QPicture>>(
+            QThreadPool::globalInstance(), batch,
+            [&report, &pageLayout](int page) { return renderPage(report, pageLayout, page); });
+
+        for (int i = 0; i < pictures.size(); ++i) {
+            if (first + i > 0) {
+                writer.newPage();
+            }
+            painter.drawPicture(0, 0, pictures[i]);
+        }
+
+        result.pages = first + pictures.size();
+        promise.setProgressValue(int(qint64(result.pages) * PROGRESS_STEPS / pageCount));
+    }
+
+    painter.end();
+    promise.addResult(result);
+}
+
+PdfReportEngine::Layout PdfReportEngine::layout(const Report& report, const QRectF& page)
+{
+    Layout result;
+    result.page = page;
+    result.unit = report.dpi / 25.4;
+    result.rowHeight = 5 * result.unit;
+    result.bandHeight = 10 * result.unit;
+
+    result.titleFont.setPointSize(16);
+    result.titleFont.setBold(true);
+    result.headingFont.setPointSize(11);
+    result.headingFont.setBold(true);
+    result.bodyFont.setPointSize(8);
+    result.smallFont.setPointSize(7);
+
+    // Every column gets its share of the full width; the timestamp needs two
+    const int valueColumns = RecordColumns::valueColumnCount();
+    const qreal columnWidth = page.width() / (valueColumns + 2);
+    result.columnEdges.append(page.left());
+    result.columnEdges.append(page.left() + 2 * columnWidth);
+    for (int column = 0; column < valueColumns; ++column) {
+        result.columnEdges.append(result.columnEdges.last() + columnWidth);
+    }
+
+    // One header row per page
+    const qreal tableHeight = page.height() - 2 * result.bandHeight;
+    result.rowsPerPage = qMax(1, int(tableHeight / result.rowHeight) - 1);
+
+    result.pages.append({SummaryPage});
+    result.pages.append({ChartsPage});
+    const int rows = report.records.size();
+    for (int first = 0; first < rows; first += result.rowsPerPage) {
+        result.pages.append({TablePage, first, qMin(rows, first + result.rowsPerPage)});
+    }
+
+    result.stats = columnStats(report.records);
+    return result;
+}
+
+QVector<PdfReportEngine::ColumnStats> PdfReportEngine::columnStats(const RecordColumns& records)
+{
+    QVector<ColumnStats> stats(RecordColumns::valueColumnCount());
+    const int rows = records.size();
+    if (rows == 0)
+        return stats;
+
+    for (int column = 0; column < stats.size(); ++column) {
+        const float* values = records.valueColumn(column).constData();
+        float min = values[0];
+        float max = values[0];
+        double sum = 0;
+        for (int row = 0; row < rows; ++row) {
+            min = qMin(min, values[row]);
+            max = qMax(max, values[row]);
+            sum += values[row];
+        }
+        stats[column] = {min, max, sum / rows};
+    }
+    return stats;
+}
+
+QPicture PdfReportEngine::renderPage(const Report& report, const Layout& layout, int pageIndex)
+{
+    QPicture picture;
+    QPainter painter(&picture);
+    painter.setPen(Qt::black);
+
+    drawBand(painter, report, layout, pageIndex);
+
+    const Page& page = layout.pages[pageIndex];
+    switch (page.kind) {
+    case SummaryPage:
+        drawSummary(painter, report, layout);
+        break;
+    case ChartsPage:
+        drawCharts(painter, report, layout);
+        break;
+    case TablePage:
+        drawTable(painter, report, layout, page);
+        break;
+    }
+
+    painter.end();
+    return picture;
+}
+
+void PdfReportEngine::drawBand(QPainter& painter, const Report& report, const Layout& layout, int pageIndex)
+{
+    const QRectF& page = layout.page;
+    painter.setFont(layout.smallFont);
+
+    const QRectF header(page.left(), page.top(), page.width(), layout.bandHeight * 0.6);
+    painter.drawText(header, Qt::AlignLeft | Qt::AlignVCenter, report.title);
+    painter.drawText(header, Qt::AlignRight | Qt::AlignVCenter, report.period);
+    painter.drawLine(QPointF(page.left(), header.bottom()), QPointF(page.right(), header.bottom()));
+
+    const QRectF footer(page.left(), page.bottom() - layout.bandHeight * 0.6, page.width(), layout.bandHeight * 0.6);
+    painter.drawText(footer, Qt::AlignCenter,
+                     QString("Page %1 of %2").arg(pageIndex + 1).arg(layout.pages.size()));
+}
+
+void PdfReportEngine::drawSummary(QPainter& painter, const Report& report, const Layout& layout)
+{
+    const QRectF& page = layout.page;
+    const RecordColumns& records = report.records;
+    qreal y = page.top() + layout.bandHeight;
+
+    painter.setFont(layout.titleFont);
+    painter.drawText(QRectF(page.left(), y, page.width(), 12 * layout.unit), Qt::AlignCenter, report.title);
+    y += 12 * layout.unit;
+
+    painter.setFont(layout.bodyFont);
+    painter.drawText(QRectF(page.left(), y, page.width(), layout.rowHeight), Qt::AlignCenter, report.period);
+    y += layout.rowHeight;
+
+    QString extent = QString("Records: %1").arg(records.size());
+    if (!records.isEmpty()) {
+        extent += QString("    First: %1    Last: %2")
+                      .arg(QDateTime::fromMSecsSinceEpoch(records.timestamps.first()).toString(Qt::ISODate),
+                           QDateTime::fromMSecsSinceEpoch(records.timestamps.last()).toString(Qt::ISODate));
+    }
+    painter.drawText(QRectF(page.left(), y, page.width(), layout.rowHeight), Qt::AlignCenter, extent);
+    y += 3 * layout.rowHeight;
+
+    // Statistics of every value column over the whole period
+    const QStringList headings = {"Column", "Minimum", "Maximum", "Average"};
+    const qreal cellWidth = 40 * layout.unit;
+    const qreal left = page.center().x() - cellWidth * headings.size() / 2;
+
+    painter.setFont(layout.headingFont);
+    for (int column = 0; column < headings.size(); ++column) {
+        const QRectF cell(left + column * cellWidth, y, cellWidth, layout.rowHeight * 1.4);
+        painter.drawRect(cell);
+        painter.drawText(cell, Qt::AlignCenter, headings[column]);
+    }
+    y += layout.rowHeight * 1.4;
+
+    painter.setFont(layout.bodyFont);
+    for (int column = 0; column < layout.stats.size(); ++column) {
+        const ColumnStats& stats = layout.stats[column];
+        const QString cells[] = {
+            RecordColumns::valueColumnHeader(column),
+            records.isEmpty() ? QString("-") : QString::number(stats.min, 'f', 2),
+            records.isEmpty() ? QString("-") : QString::number(stats.max, 'f', 2),
+            records.isEmpty() ? QString("-") : QString::number(stats.mean, 'f', 2),
+        };
+        for (int cell = 0; cell < headings.size(); ++cell) {
+            const QRectF rect(left + cell * cellWidth, y, cellWidth, layout.rowHeight);
+            painter.drawRect(rect);
+            painter.drawText(rect, Qt::AlignCenter, cells[cell]);
+        }
+        y += layout.rowHeight;
+    }
+}
+
+void PdfReportEngine::drawCharts(QPainter& painter, const Report& report, const Layout& layout)
+{
+    const QRectF& page = layout.page;
+    const qreal gap = 4 * layout.unit;
+    const qreal top = page.top() + layout.bandHeight;
+    const qreal height = (page.height() - 2 * layout.bandHeight - gap * (ChannelSchema::ChartCount - 1))
+                         / ChannelSchema::ChartCount;
+
+    for (int chart = 0; chart < ChannelSchema::ChartCount; ++chart) {
+        const QRectF area(page.left(), top + chart * (height + gap), page.width(), height);
+        drawChart(painter, report, layout, area, ChannelSchema::ChartQuantities[chart]);
+    }
+}
+
+void PdfReportEngine::drawChart(QPainter& painter, const Report& report, const Layout& layout,
+                                const QRectF& area, ChannelSchema::Quantity quantity)
+{
+    const RecordColumns& records = report.records;
+    const qreal unit = layout.unit;
+
+    painter.setFont(layout.headingFont);
+    painter.drawText(QRectF(area.left(), area.top(), area.width(), 6 * unit), Qt::AlignLeft | Qt::AlignVCenter,
+                     ChannelSchema::axisTitle(quantity));
+
+    const QRectF plot = area.adjusted(18 * unit, 7 * unit, -2 * unit, -6 * unit);
+    painter.drawRect(plot);
+
+    painter.setFont(layout.smallFont);
+    if (records.isEmpty()) {
+        painter.drawText(plot, Qt::AlignCenter, "No data");
+        return;
+    }
+
+    // The quantity's total, then its channels
+    const int first = ChannelSchema::firstChannel(quantity);
+    const int count = ChannelSchema::channelCount(quantity);
+    QVector<const float*> series;
+    series.append(records.totals[quantity].constData());
+    for (int channel = first; channel < first + count; ++channel) {
+        series.append(records.channels[channel].constData());
+    }
+
+    // Min/max per time bucket of half a millimetre, so every peak survives
+    const int rows = records.size();
+    const int buckets = qMax(1, int(plot.width() / (0.5 * unit)));
+    const qint64 startMs = records.timestamps.first();
+    const qint64 spanMs = qMax<qint64>(1, records.timestamps.last() - startMs + 1);
+    QVector<int> bucketOf(rows);
+    for (int row = 0; row < rows; ++row) {
+        bucketOf[row] = qBound(0, int((records.timestamps[row] - startMs) * buckets / spanMs), buckets - 1);
+    }
+
+    QVector<QVector<float>> minima(series.size(), QVector<float>(buckets, std::numeric_limits<float>::max()));
+    QVector<QVector<float>> maxima(series.size(), QVector<float>(buckets, std::numeric_limits<float>::lowest()));
+    double low = std::numeric_limits<double>::max();
+    double high = std::numeric_limits<double>::lowest();
+    for (int s = 0; s < series.size(); ++s) {
+        float* minimum = minima[s].data();
+        float* maximum = maxima[s].data();
+        const float* values = series[s];
+        for (int row = 0; row < rows; ++row) {
+            minimum[bucketOf[row]] = qMin(minimum[bucketOf[row]], values[row]);
+            maximum[bucketOf[row]] = qMax(maximum[bucketOf[row]], values[row]);
+        }
+        for (int bucket = 0; bucket < buckets; ++bucket) {
+            if (minimum[bucket] <= maximum[bucket]) {
+                low = qMin(low, double(minimum[bucket]));
+                high = qMax(high, double(maximum[bucket]));
+            }
+        }
+    }
+
+    // Same nice bounds as the live charts
+    NiceAxisRange range(1.0);
+    range.update(low, high);
+    const double lower = range.lower();
+    const double upper = range.upper();
+
+    // Grid and value labels
+    static const int GRID_LINES = 4;
+    painter.setPen(QPen(QColor("#bbbbbb"), 0));
+    for (int line = 1; line < GRID_LINES; ++line) {
+        const qreal y = plot.bottom() - plot.height() * line / GRID_LINES;
+        painter.drawLine(QPointF(plot.left(), y), QPointF(plot.right(), y));
+    }
+    painter.setPen(Qt::black);
+    for (int line = 0; line <= GRID_LINES; ++line) {
+        const qreal y = plot.bottom() - plot.height() * line / GRID_LINES;
+        const double value = lower + (upper - lower) * line / GRID_LINES;
+        painter.drawText(QRectF(area.left(), y - 3 * unit, 16 * unit, 6 * unit), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(value, 'g', 6));
+    }
+
+    // Time labels at both ends and in the middle
+    const QRectF timeBand(plot.left(), plot.bottom() + unit, plot.width(), 4 * unit);
+    const qint64 endMs = records.timestamps.last();
+    painter.drawText(timeBand, Qt::AlignLeft | Qt::AlignTop,
+                     QDateTime::fromMSecsSinceEpoch(startMs).toString("yyyy-MM-dd HH:mm"));
+    painter.drawText(timeBand, Qt::AlignHCenter | Qt::AlignTop,
+                     QDateTime::fromMSecsSinceEpoch(startMs + (endMs - startMs) / 2).toString("yyyy-MM-dd HH:mm"));
+    painter.drawText(timeBand, Qt::AlignRight | Qt::AlignTop,
+                     QDateTime::fromMSecsSinceEpoch(endMs).toString("yyyy-MM-dd HH:mm"));
+
+    // Total in the location's colour, phases in fixed colours
+    const QColor phaseColors[] = {QColor("#c0392b"), QColor("#27ae60"), QColor("#2980b9")};
+    const qreal xScale = plot.width() / buckets;
+    const qreal yScale = plot.height() / (upper - lower);
+
+    painter.save();
+    painter.setClipRect(plot);
+    painter.setRenderHint(QPainter::Antialiasing);
+    QPolygonF line;
+    for (int s = series.size() - 1; s >= 0; --s) {
+        const QColor color = s == 0 ? report.color : phaseColors[(s - 1) % 3];
+        painter.setPen(QPen(color, s == 0 ? 0.5 * unit : 0.25 * unit));
+
+        // A bucket without samples breaks the line
+        line.clear();
+        for (int bucket = 0; bucket <= buckets; ++bucket) {
+            if (bucket == buckets || minima[s][bucket] > maxima[s][bucket]) {
+                if (line.size() > 1) {
+                    painter.drawPolyline(line);
+                }
+                line.clear();
+                continue;
+            }
+            const qreal x = plot.left() + (bucket + 0.5) * xScale;
+            line.append(QPointF(x, plot.bottom() - (minima[s][bucket] - lower) * yScale));
+            line.append(QPointF(x, plot.bottom() - (maxima[s][bucket] - lower) * yScale));
+        }
+    }
+    painter.restore();
+
+    // Legend, right-aligned above the plot
+    qreal x = plot.right();
+    for (int s = series.size() - 1; s >= 0; --s) {
+        const QString label = s == 0 ? ChannelSchema::totalHeader(quantity)
+                                     : ChannelSchema::columnHeader(first + s - 1);
+        const qreal width = painter.fontMetrics().horizontalAdvance(label) + 6 * unit;
+        x -= width;
+        const QColor color = s == 0 ? report.color : phaseColors[(s - 1) % 3];
+        painter.fillRect(QRectF(x, area.top() + 2 * unit, 3 * unit, 2 * unit), color);
+        painter.drawText(QRectF(x + 4 * unit, area.top(), width - 4 * unit, 6 * unit),
+                         Qt::AlignLeft | Qt::AlignVCenter, label);
+    }
+}
+
+void PdfReportEngine::drawTable(QPainter& painter, const Report& report, const Layout& layout, const Page& page)
+{
+    const RecordColumns& records = report.records;
+    const QVector<qreal>& edges = layout.columnEdges;
+    const int valueColumns = RecordColumns::valueColumnCount();
+    const qreal top = layout.page.top() + layout.bandHeight;
+    const qreal rowHeight = layout.rowHeight;
+
+    QVector<const float*> columns(valueColumns);
+    for (int column = 0; column < valueColumns; ++column) {
+        columns[column] = records.valueColumn(column).constData();
+    }
+
+    // Header row
+    QFont headerFont = layout.bodyFont;
+    headerFont.setBold(true);
+    painter.setFont(headerFont);
+    painter.drawText(QRectF(edges[0], top, edges[1] - edges[0], rowHeight), Qt::AlignCenter, "Timestamp");
+    for (int column = 0; column < valueColumns; ++column) {
+        painter.drawText(QRectF(edges[column + 1], top, edges[column + 2] - edges[column + 1], rowHeight),
+                         Qt::AlignCenter, RecordColumns::valueColumnHeader(column));
+    }
+
+    // Cells; the grid is drawn once per page instead of a rectangle per cell
+    painter.setFont(layout.bodyFont);
+    qreal y = top + rowHeight;
+    for (int row = page.firstRow; row < page.lastRow; ++row, y += rowHeight) {
+        painter.drawText(QRectF(edges[0], y, edges[1] - edges[0], rowHeight), Qt::AlignCenter,
+                         QDateTime::fromMSecsSinceEpoch(records.timestamps[row]).toString(Qt::ISODate));
+        for (int column = 0; column < valueColumns; ++column) {
+            painter.drawText(QRectF(edges[column + 1], y, edges[column + 2] - edges[column + 1], rowHeight),
+                             Qt::AlignCenter, QString::number(columns[column][row], 'f', 2));
+        }
+    }
+
+    const qreal bottom = y;
+    for (qreal lineY = top; lineY <= bottom + 0.5; lineY += rowHeight) {
+        painter.drawLine(QPointF(edges.first(), lineY), QPointF(edges.last(), lineY));
+    }
+    for (qreal edge : edges) {
+        painter.drawLine(QPointF(edge, top), QPointF(edge, bottom));
+    }
+}
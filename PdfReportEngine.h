@@ -0,0 +1,90 @@
+// PdfReportEngine.h
+#ifndef PDFREPORTENGINE_H
+#define PDFREPORTENGINE_H
+
+#include <QColor>
+#include <QFont>
+#include <QPicture>
+#include <QPromise>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include "RecordColumns.h"
+
+class QPainter;
+
+// Builds the PDF report of DataRecordDialog, for QtConcurrent::run() on a
+// thread that is not part of the global pool. The whole document is laid out
+// first (a summary page, a page of downsampled history charts, then the
+// record table in pages of fixed row count), so every page can be rendered
+// on its own: pages are drawn into QPictures in parallel on the global pool,
+// a batch at a time, and replayed in order into one QPdfWriter. Memory stays
+// bounded by the batch, whatever the page count.
+//
+// Progress is reported on the promise in [0, PROGRESS_STEPS]; cancelling the
+// future stops after the current batch and removes the partial file.
+class PdfReportEngine
+{
+public:
+    struct Report {
+        QString fileName;
+        QString title;        // "Data Report - Building 1"
+        QString period;       // "Period: ... to ..."
+        QColor color;         // location colour, for the charts
+        int dpi = 96;         // logical DPI of QPicture, see render()
+        RecordColumns records;
+    };
+
+    struct Result {
+        int pages = 0;
+        QString error;   // empty on success
+    };
+
+    static const int PROGRESS_STEPS = 1000;
+
+    static void render(QPromise<Result>& promise, const Report& report);
+
+private:
+    enum PageKind { SummaryPage, ChartsPage, TablePage };
+
+    struct Page {
+        PageKind kind;
+        int firstRow = 0;
+        int lastRow = 0;   // exclusive
+    };
+
+    struct ColumnStats {
+        float min = 0;
+        float max = 0;
+        double mean = 0;
+    };
+
+    // Everything rendering needs, computed once before any page is drawn
+    struct Layout {
+        QRectF page;                // printable area, in device units
+        qreal unit = 1;             // device units per millimetre
+        qreal rowHeight = 0;
+        qreal bandHeight = 0;       // running header and footer
+        QVector<qreal> columnEdges; // x of every column border, left to right
+        int rowsPerPage = 0;
+        QFont titleFont;
+        QFont headingFont;
+        QFont bodyFont;
+        QFont smallFont;
+        QVector<Page> pages;
+        QVector<ColumnStats> stats;
+    };
+
+    static Layout layout(const Report& report, const QRectF& page);
+    static QVector<ColumnStats> columnStats(const RecordColumns& records);
+
+    static QPicture renderPage(const Report& report, const Layout& layout, int pageIndex);
+    static void drawBand(QPainter& painter, const Report& report, const Layout& layout, int pageIndex);
+    static void drawSummary(QPainter& painter, const Report& report, const Layout& layout);
+    static void drawCharts(QPainter& painter, const Report& report, const Layout& layout);
+    static void drawChart(QPainter& painter, const Report& report, const Layout& layout,
+                          const QRectF& area, ChannelSchema::Quantity quantity);
+    static void drawTable(QPainter& painter, const Report& report, const Layout& layout, const Page& page);
+};
+
+#endif // PDFREPORTENGINE_H
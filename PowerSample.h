@@ -0,0 +1,17 @@
+// PowerSample.h
+#ifndef POWERSAMPLE_H
+#define POWERSAMPLE_H
+
+#include <QtGlobal>
+#include "ChannelSchema.h"
+
+// One decoded meter reading. Filled in on the ingest thread so the GUI thread
+// never has to look at raw socket text.
+struct PowerSample {
+    qint64 timestampMs = 0;
+    int topicId = -1;
+    // Indexed by ChannelSchema::Channel
+    float values[ChannelSchema::ChannelCount] = {};
+};
+
+#endif // POWERSAMPLE_H
@@ -0,0 +1,470 @@
+// RecordArchive.cpp
+#include "RecordArchive.h"
+#include "SampleStore.h"
+#include <QAtomicInt>
+#include <QDataStream>
+#include <QFile>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrentMap>
+#include <cstring>
+#include <limits>
+
+static const char MAGIC[4] = {'P', 'R', 'C', 'A'};
+static const int HEADER_SIZE = 8;
+// quint32 footer size, then the magic again
+static const int TRAILER_SIZE = 8;
+static const char* const TIMESTAMP_KEY = "timestamp";
+
+// Row groups and their column chunks as they are written, then the footer
+class RecordArchive::Writer
+{
+public:
+    Writer(const QString& fileName, const QString& topic)
+        : m_file(fileName),
+        m_topic(topic)
+    {
+    }
+
+    bool open()
+    {
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        char header[HEADER_SIZE];
+        std::memcpy(header, MAGIC, 4);
+        qToLittleEndian<quint16>(FORMAT_VERSION, header + 4);
+        qToLittleEndian<quint16>(0, header + 6);
+        write(header, HEADER_SIZE);
+        return !m_failed;
+    }
+
+    QString errorString() const { return m_file.errorString(); }
+    bool failed() const { return m_failed; }
+
+    // Leaves nothing behind after a cancelled or failed export
+    void discard()
+    {
+        m_file.close();
+        m_file.remove();
+    }
+
+    // Rows [first, last) of the records, as row groups of at most ROW_GROUP_ROWS
+    void writeRows(const RecordColumns& records, int first, int last)
+    {
+        for (int groupFirst = first; groupFirst < last && !m_failed; groupFirst += ROW_GROUP_ROWS) {
+            writeGroup(records, groupFirst, qMin(last, groupFirst + ROW_GROUP_ROWS));
+        }
+    }
+
+    bool close()
+    {
+        QByteArray footer;
+        QDataStream stream(&footer, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        stream.setVersion(QDataStream::Qt_6_0);
+
+        stream << m_topic << m_rows;
+        stream << quint16(1 + ChannelSchema::ChannelCount);
+        stream << QByteArray(TIMESTAMP_KEY) << quint8(TimestampDeltas);
+        for (const ChannelSchema::ChannelInfo& channel : ChannelSchema::Channels) {
+            stream << QByteArray(channel.key) << quint8(FloatByteSplit);
+        }
+
+        stream << quint32(m_groups.size());
+        for (const Group& group : m_groups) {
+            stream << group.rows << group.firstMs << group.lastMs;
+            for (const Chunk& chunk : group.chunks) {
+                stream << chunk.offset << chunk.size << chunk.flags;
+            }
+        }
+
+        char trailer[TRAILER_SIZE];
+        qToLittleEndian<quint32>(quint32(footer.size()), trailer);
+        std::memcpy(trailer + 4, MAGIC, 4);
+        write(footer.constData(), footer.size());
+        write(trailer, TRAILER_SIZE);
+
+        m_file.close();
+        return !m_failed;
+    }
+
+private:
+    struct Chunk {
+        qint64 offset;
+        qint64 size;
+        quint8 flags;
+    };
+
+    struct Group {
+        qint32 rows;
+        qint64 firstMs;
+        qint64 lastMs;
+        QVector<Chunk> chunks;
+    };
+
+    void writeGroup(const RecordColumns& records, int first, int last)
+    {
+        const int rows = last - first;
+        Group group{rows, records.timestamps[first], records.timestamps[last - 1], {}};
+
+        writeChunk(group, encodeTimestamps(records.timestamps.constData() + first, rows));
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            writeChunk(group, encodeFloats(records.channels[channel].constData() + first, rows));
+        }
+
+        m_groups.append(group);
+        m_rows += rows;
+    }
+
+    void writeChunk(Group& group, const QByteArray& encoded)
+    {
+        // Kept as is when zlib can't shrink it, e.g. noisy low-order bytes
+        Chunk chunk{m_file.pos(), 0, 0};
+        const QByteArray compressed = qCompress(encoded);
+        if (compressed.size() < encoded.size()) {
+            chunk.flags = Compressed;
+            write(compressed.constData(), compressed.size());
+            chunk.size = compressed.size();
+        } else {
+            write(encoded.constData(), encoded.size());
+            chunk.size = encoded.size();
+        }
+        group.chunks.append(chunk);
+    }
+
+    void write(const char* data, qint64 size)
+    {
+        if (!m_failed && m_file.write(data, size) != size) {
+            m_failed = true;
+        }
+    }
+
+    QFile m_file;
+    QString m_topic;
+    qint64 m_rows = 0;
+    QVector<Group> m_groups;
+    bool m_failed = false;
+};
+
+void RecordArchive::exportColumns(QPromise<Result>& promise, const QString& fileName,
+                                  const QString& topic, const RecordColumns& records)
+{
+    Result result;
+    Writer writer(fileName, topic);
+    if (!writer.open()) {
+        result.error = writer.errorString();
+        promise.addResult(result);
+        return;
+    }
+
+    promise.setProgressRange(0, PROGRESS_STEPS);
+
+    const int rows = records.size();
+    for (int first = 0; first < rows; first += ROW_GROUP_ROWS) {
+        if (promise.isCanceled()) {
+            writer.discard();
+            return;
+        }
+
+        const int last = qMin(rows, first + ROW_GROUP_ROWS);
+        writer.writeRows(records, first, last);
+        if (writer.failed())
+            break;
+        result.rows = last;
+        promise.setProgressValue(int(qint64(last) * PROGRESS_STEPS / rows));
+    }
+
+    if (!writer.close()) {
+        result.error = writer.errorString();
+        writer.discard();
+    }
+    promise.addResult(result);
+}
+
+void RecordArchive::exportStore(QPromise<Result>& promise, const QString& fileName,
+                                const QString& topic, qint64 fromMs, qint64 toMs)
+{
+    // One store segment per step, so cancel and progress are never far off
+    static const qint64 SLICE_MS = 60 * 60 * 1000;
+
+    Result result;
+    Writer writer(fileName, topic);
+    if (!writer.open()) {
+        result.error = writer.errorString();
+        promise.addResult(result);
+        return;
+    }
+
+    promise.setProgressRange(0, PROGRESS_STEPS);
+
+    const SampleStore store;
+    RecordColumns slice;
+    for (qint64 sliceFromMs = fromMs; sliceFromMs <= toMs; sliceFromMs += SLICE_MS) {
+        if (promise.isCanceled()) {
+            writer.discard();
+            return;
+        }
+
+        // Channels only; totals are derived again on load
+        const qint64 sliceToMs = qMin(toMs, sliceFromMs + SLICE_MS - 1);
+        slice.clear();
+        store.query(topic, sliceFromMs, sliceToMs, [&slice](const PowerSample& sample) { slice.append(sample); });
+
+        writer.writeRows(slice, 0, slice.size());
+        if (writer.failed())
+            break;
+        result.rows += slice.size();
+        if (toMs > fromMs) {
+            promise.setProgressValue(int((sliceToMs - fromMs) * PROGRESS_STEPS / (toMs - fromMs)));
+        }
+    }
+
+    if (!writer.close()) {
+        result.error = writer.errorString();
+        writer.discard();
+    }
+    promise.addResult(result);
+}
+
+RecordArchive::Contents RecordArchive::load(const QString& fileName)
+{
+    Contents contents;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        contents.error = file.errorString();
+        return contents;
+    }
+
+    const qint64 size = file.size();
+    const uchar* data = size >= HEADER_SIZE + TRAILER_SIZE ? file.map(0, size) : nullptr;
+    if (!data || std::memcmp(data, MAGIC, 4) != 0 || std::memcmp(data + size - 4, MAGIC, 4) != 0) {
+        contents.error = "Not a record archive";
+        return contents;
+    }
+    if (qFromLittleEndian<quint16>(data + 4) != FORMAT_VERSION) {
+        contents.error = "Unsupported record archive version";
+        return contents;
+    }
+
+    // The footer says where everything is
+    const qint64 footerSize = qFromLittleEndian<quint32>(data + size - TRAILER_SIZE);
+    const qint64 footerStart = size - TRAILER_SIZE - footerSize;
+    if (footerStart < HEADER_SIZE) {
+        contents.error = "Corrupt record archive";
+        return contents;
+    }
+
+    QDataStream stream(QByteArray::fromRawData(reinterpret_cast<const char*>(data) + footerStart, footerSize));
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    qint64 rows = 0;
+    quint16 columnCount = 0;
+    stream >> contents.topic >> rows >> columnCount;
+
+    // Where each stored column goes: the timestamps, a channel, or nowhere.
+    // Groups decode in parallel, so no two columns may share a target.
+    static const int TIMESTAMP_COLUMN = -2;
+    static const int SKIPPED_COLUMN = -1;
+    QVector<int> targets(columnCount, SKIPPED_COLUMN);
+    bool hasTimestamps = false;
+    quint64 mappedChannels = 0;
+    for (int column = 0; column < columnCount; ++column) {
+        QByteArray key;
+        quint8 encoding = 0;
+        stream >> key >> encoding;
+        if (key == TIMESTAMP_KEY && encoding == TimestampDeltas) {
+            if (hasTimestamps) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+            }
+            targets[column] = TIMESTAMP_COLUMN;
+            hasTimestamps = true;
+        } else if (encoding == FloatByteSplit) {
+            const int channel = ChannelSchema::channelForKey(QString::fromLatin1(key));
+            if (channel >= 0 && (mappedChannels & (quint64(1) << channel))) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+            } else if (channel >= 0) {
+                mappedChannels |= quint64(1) << channel;
+            }
+            targets[column] = channel;
+        }
+    }
+
+    struct Chunk {
+        qint64 offset;
+        qint64 size;
+        quint8 flags;
+    };
+    quint32 groupCount = 0;
+    stream >> groupCount;
+    QVector<int> groupFirstRow;
+    QVector<int> groupRows;
+    QVector<Chunk> chunks;
+    qint64 totalRows = 0;
+    for (quint32 group = 0; group < groupCount && stream.status() == QDataStream::Ok; ++group) {
+        qint32 groupSize = 0;
+        qint64 firstMs = 0;
+        qint64 lastMs = 0;
+        stream >> groupSize >> firstMs >> lastMs;
+        if (groupSize < 0) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+        }
+        groupFirstRow.append(int(qMin<qint64>(totalRows, std::numeric_limits<int>::max())));
+        groupRows.append(groupSize);
+        totalRows += groupSize;
+
+        for (int column = 0; column < columnCount; ++column) {
+            Chunk chunk{0, 0, 0};
+            stream >> chunk.offset >> chunk.size >> chunk.flags;
+            if (chunk.offset < HEADER_SIZE || chunk.size < 0 || chunk.offset + chunk.size > footerStart) {
+                stream.setStatus(QDataStream::ReadCorruptData);
+            }
+            chunks.append(chunk);
+        }
+    }
+
+    if (stream.status() != QDataStream::Ok || !hasTimestamps || totalRows != rows
+        || rows > std::numeric_limits<int>::max()) {
+        contents.error = "Corrupt record archive";
+        contents.topic.clear();
+        return contents;
+    }
+
+    // Columns are sized once and every row group decodes into its own
+    // slice of them, so groups run in parallel without any merging
+    RecordColumns& records = contents.records;
+    records.timestamps.resize(rows);
+    for (QVector<float>& column : records.channels) {
+        column.resize(rows);
+    }
+
+    qint64* timestamps = records.timestamps.data();
+    float* channels[ChannelSchema::ChannelCount];
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        channels[channel] = records.channels[channel].data();
+    }
+
+    QVector<int> groups(int(groupCount));
+    for (int group = 0; group < groups.size(); ++group) {
+        groups[group] = group;
+    }
+
+    QAtomicInt failures;
+    QtConcurrent::blockingMap(groups, [&](int group) {
+        const int firstRow = groupFirstRow[group];
+        const int groupSize = groupRows[group];
+        for (int column = 0; column < columnCount; ++column) {
+            const int target = targets[column];
+            if (target == SKIPPED_COLUMN)
+                continue;
+
+            // Uncompressed chunks are decoded straight from the mapping
+            const Chunk& chunk = chunks[group * columnCount + column];
+            const char* bytes = reinterpret_cast<const char*>(data) + chunk.offset;
+            const QByteArray encoded = (chunk.flags & Compressed)
+                                           ? qUncompress(reinterpret_cast<const uchar*>(bytes), chunk.size)
+                                           : QByteArray::fromRawData(bytes, chunk.size);
+
+            const bool decoded = target == TIMESTAMP_COLUMN
+                                     ? decodeTimestamps(encoded, timestamps + firstRow, groupSize)
+                                     : decodeFloats(encoded, channels[target] + firstRow, groupSize);
+            if (!decoded) {
+                failures.ref();
+            }
+        }
+    });
+
+    file.unmap(const_cast<uchar*>(data));
+
+    if (failures.loadRelaxed() > 0) {
+        contents.error = "Corrupt record archive";
+        contents.topic.clear();
+        records.clear();
+        return contents;
+    }
+
+    records.computeTotals();
+    return contents;
+}
+
+QByteArray RecordArchive::encodeTimestamps(const qint64* timestamps, int rows)
+{
+    QByteArray out;
+    out.reserve(rows * 2);
+
+    qint64 previous = 0;
+    qint64 previousDelta = 0;
+    for (int row = 0; row < rows; ++row) {
+        const qint64 delta = timestamps[row] - previous;
+        const qint64 deltaOfDelta = delta - previousDelta;
+        previous = timestamps[row];
+        previousDelta = delta;
+
+        // Zigzag, so small negative jitter stays small too
+        quint64 value = (quint64(deltaOfDelta) << 1) ^ quint64(deltaOfDelta >> 63);
+        while (value >= 0x80) {
+            out.append(char(value | 0x80));
+            value >>= 7;
+        }
+        out.append(char(value));
+    }
+    return out;
+}
+
+bool RecordArchive::decodeTimestamps(const QByteArray& data, qint64* timestamps, int rows)
+{
+    const uchar* in = reinterpret_cast<const uchar*>(data.constData());
+    const uchar* end = in + data.size();
+
+    qint64 previous = 0;
+    qint64 previousDelta = 0;
+    for (int row = 0; row < rows; ++row) {
+        quint64 value = 0;
+        for (int shift = 0;; shift += 7) {
+            if (in == end || shift > 63)
+                return false;
+            const uchar byte = *in++;
+            value |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                break;
+        }
+
+        const qint64 deltaOfDelta = qint64(value >> 1) ^ -qint64(value & 1);
+        previousDelta += deltaOfDelta;
+        previous += previousDelta;
+        timestamps[row] = previous;
+    }
+    return in == end;
+}
+
+QByteArray RecordArchive::encodeFloats(const float* values, int rows)
+{
+    // Plane k holds byte k of every value: exponents and high mantissa bits
+    // of a slowly changing signal repeat, which zlib then removes
+    QByteArray out(qsizetype(rows) * 4, Qt::Uninitialized);
+    uchar* planes = reinterpret_cast<uchar*>(out.data());
+    for (int row = 0; row < rows; ++row) {
+        quint32 bits;
+        std::memcpy(&bits, &values[row], sizeof(bits));
+        planes[row] = uchar(bits);
+        planes[rows + row] = uchar(bits >> 8);
+        planes[2 * rows + row] = uchar(bits >> 16);
+        planes[3 * rows + row] = uchar(bits >> 24);
+    }
+    return out;
+}
+
+bool RecordArchive::decodeFloats(const QByteArray& data, float* values, int rows)
+{
+    if (data.size() != qsizetype(rows) * 4)
+        return false;
+
+    const uchar* planes = reinterpret_cast<const uchar*>(data.constData());
+    for (int row = 0; row < rows; ++row) {
+        const quint32 bits = quint32(planes[row]) | quint32(planes[rows + row]) << 8
+                             | quint32(planes[2 * rows + row]) << 16 | quint32(planes[3 * rows + row]) << 24;
+        std::memcpy(&values[row], &bits, sizeof(bits));
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+// RecordArchive.h
+#ifndef RECORDARCHIVE_H
+#define RECORDARCHIVE_H
+
+#include <QByteArray>
+#include <QPromise>
+#include <QString>
+#include "RecordColumns.h"
+
+// Compact columnar file of one topic's history records, for moving long
+// periods between machines and opening them again in DataRecordDialog.
+// Laid out like Parquet, all integers little-endian:
+//   "PRCA", quint16 version, quint16 reserved
+//   row groups of up to ROW_GROUP_ROWS rows, each one chunk per column
+//   footer, written with QDataStream (little-endian, Qt 6.0):
+//     QString topic, qint64 rows,
+//     quint16 columns, per column QByteArray key ("timestamp", then the
+//       ChannelSchema keys) and quint8 encoding,
+//     quint32 row groups, per group qint32 rows, qint64 first and last
+//       timestamp, then per column qint64 offset, qint64 size, quint8 flags
+//   quint32 footer size, "PRCA"
+// Timestamps are stored as zigzag varints of their delta-of-deltas (a byte
+// each at a regular rate), floats split into byte planes so equal high
+// bytes line up. Each chunk is then zlib-compressed (qCompress()) unless
+// that does not make it smaller. Totals are not stored; they are derived on
+// load. Channels are matched by key, so files stay readable when the schema
+// grows: unknown columns are skipped, missing ones read as 0.
+//
+// Export runs on a worker thread through QtConcurrent::run(), with progress
+// in [0, PROGRESS_STEPS]; cancelling removes the partial file. load() maps
+// the file and decodes its row groups in parallel.
+class RecordArchive
+{
+public:
+    struct Result {
+        qint64 rows = 0;
+        QString error;   // empty on success
+    };
+
+    struct Contents {
+        QString topic;
+        RecordColumns records;   // totals included
+        QString error;           // empty on success
+    };
+
+    static const int PROGRESS_STEPS = 1000;
+
+    // Records already in memory, e.g. what the record table holds
+    static void exportColumns(QPromise<Result>& promise, const QString& fileName,
+                              const QString& topic, const RecordColumns& records);
+    // Everything stored locally for [fromMs, toMs], one row group per hour;
+    // only complete if SampleStore::covers() the period
+    static void exportStore(QPromise<Result>& promise, const QString& fileName,
+                            const QString& topic, qint64 fromMs, qint64 toMs);
+
+    static Contents load(const QString& fileName);
+
+private:
+    class Writer;
+
+    enum Encoding : quint8 { TimestampDeltas, FloatByteSplit };
+    enum ChunkFlag : quint8 { Compressed = 1 };
+
+    static const quint16 FORMAT_VERSION = 1;
+    static const int ROW_GROUP_ROWS = 64 * 1024;
+
+    static QByteArray encodeTimestamps(const qint64* timestamps, int rows);
+    static bool decodeTimestamps(const QByteArray& data, qint64* timestamps, int rows);
+    static QByteArray encodeFloats(const float* values, int rows);
+    static bool decodeFloats(const QByteArray& data, float* values, int rows);
+};
+
+#endif // RECORDARCHIVE_H
@@ -0,0 +1,108 @@
+// RecordCache.cpp
+#include "RecordCache.h"
+
+RecordCache* RecordCache::instance()
+{
+    static RecordCache cache;
+    return &cache;
+}
+
+QVector<RecordCache::Piece> RecordCache::lookup(const QString& topic, qint64 fromMs, qint64 toMs)
+{
+    QVector<Piece> pieces;
+    qint64 position = fromMs;
+
+    auto spans = m_spans.find(topic);
+    if (spans != m_spans.end()) {
+        for (Span& span : *spans) {
+            if (span.toMs <= position)
+                continue;
+            if (span.fromMs >= toMs)
+                break;
+
+            if (span.fromMs > position) {
+                pieces.append({position, span.fromMs, false, {}});
+                position = span.fromMs;
+            }
+            const qint64 end = qMin(span.toMs, toMs);
+            pieces.append({position, end, true, span.records.between(position, end)});
+            span.lastUsed = ++m_clock;
+            position = end;
+        }
+    }
+
+    if (position < toMs) {
+        pieces.append({position, toMs, false, {}});
+    }
+    return pieces;
+}
+
+void RecordCache::insert(const QString& topic, qint64 fromMs, qint64 toMs, const RecordColumns& records)
+{
+    if (fromMs >= toMs)
+        return;
+
+    Span merged{fromMs, toMs, records.between(fromMs, toMs), ++m_clock};
+    merged.records.malformed = 0;
+
+    // Spans that overlap or touch the new one are folded into it; what they
+    // hold outside the new range is kept, the rest is replaced
+    QVector<Span>& spans = m_spans[topic];
+    int index = 0;
+    while (index < spans.size() && spans[index].toMs < fromMs) {
+        ++index;
+    }
+
+    RecordColumns before;
+    RecordColumns after;
+    while (index < spans.size() && spans[index].fromMs <= toMs) {
+        const Span& span = spans[index];
+        if (span.fromMs < fromMs) {
+            before = span.records.between(span.fromMs, fromMs);
+            merged.fromMs = span.fromMs;
+        }
+        if (span.toMs > toMs) {
+            after = span.records.between(toMs, span.toMs);
+            merged.toMs = span.toMs;
+        }
+        m_usage -= span.records.memoryUsage();
+        spans.removeAt(index);
+    }
+
+    if (!before.isEmpty() || !after.isEmpty()) {
+        before.append(merged.records);
+        before.append(after);
+        merged.records = before;
+    }
+
+    m_usage += merged.records.memoryUsage();
+    spans.insert(index, merged);
+    evict();
+}
+
+void RecordCache::clear()
+{
+    m_spans.clear();
+    m_usage = 0;
+}
+
+void RecordCache::evict()
+{
+    while (m_usage > BUDGET) {
+        QVector<Span>* oldestSpans = nullptr;
+        int oldest = -1;
+        for (auto spans = m_spans.begin(); spans != m_spans.end(); ++spans) {
+            for (int index = 0; index < spans->size(); ++index) {
+                if (!oldestSpans || spans->at(index).lastUsed < oldestSpans->at(oldest).lastUsed) {
+                    oldestSpans = &*spans;
+                    oldest = index;
+                }
+            }
+        }
+        if (!oldestSpans)
+            break;
+
+        m_usage -= oldestSpans->at(oldest).records.memoryUsage();
+        oldestSpans->removeAt(oldest);
+    }
+}
@@ -0,0 +1,57 @@
+// RecordCache.h
+#ifndef RECORDCACHE_H
+#define RECORDCACHE_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "RecordColumns.h"
+
+// History records already fetched from /recordData, kept per topic by time
+// range for the lifetime of the process, so DataRecordDialog only asks the
+// backend for the parts of a window it has not seen. Ranges are half-open,
+// [fromMs, toMs); overlapping and adjacent ranges merge into one span. Once
+// the cache outgrows its budget, spans are dropped least recently used first.
+// GUI thread only.
+class RecordCache
+{
+public:
+    // Part of a looked up window: either served from the cache or a gap
+    struct Piece {
+        qint64 fromMs;
+        qint64 toMs;
+        bool cached;
+        RecordColumns records;   // empty for gaps
+    };
+
+    static RecordCache* instance();
+
+    // The window split into cached pieces and gaps, in time order
+    QVector<Piece> lookup(const QString& topic, qint64 fromMs, qint64 toMs);
+    // Every record of [fromMs, toMs), in time order; records outside are dropped
+    void insert(const QString& topic, qint64 fromMs, qint64 toMs, const RecordColumns& records);
+    void clear();
+
+    qint64 memoryUsage() const { return m_usage; }
+
+private:
+    RecordCache() = default;
+
+    struct Span {
+        qint64 fromMs;
+        qint64 toMs;
+        RecordColumns records;
+        quint64 lastUsed;
+    };
+
+    static constexpr qint64 BUDGET = qint64(64) * 1024 * 1024;
+
+    void evict();
+
+    // Per topic, sorted and disjoint; touching spans are always merged
+    QHash<QString, QVector<Span>> m_spans;
+    quint64 m_clock = 0;
+    qint64 m_usage = 0;
+};
+
+#endif // RECORDCACHE_H
@@ -0,0 +1,245 @@
+// RecordColumns.cpp
+#include "RecordColumns.h"
+#include "RecordStreamParser.h"
+#include "SampleStore.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <algorithm>
+#include <numeric>
+
+void RecordColumns::clear()
+{
+    timestamps.clear();
+    for (QVector<float>& column : channels) {
+        column.clear();
+    }
+    for (QVector<float>& column : totals) {
+        column.clear();
+    }
+    malformed = 0;
+}
+
+void RecordColumns::reserve(int rows)
+{
+    timestamps.reserve(rows);
+    for (QVector<float>& column : channels) {
+        column.reserve(rows);
+    }
+    for (QVector<float>& column : totals) {
+        column.reserve(rows);
+    }
+}
+
+void RecordColumns::append(const PowerSample& sample)
+{
+    timestamps.append(sample.timestampMs);
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        channels[channel].append(sample.values[channel]);
+    }
+}
+
+void RecordColumns::append(const RecordColumns& other)
+{
+    timestamps += other.timestamps;
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        channels[channel] += other.channels[channel];
+    }
+    for (int quantity = 0; quantity < ChannelSchema::QuantityCount; ++quantity) {
+        totals[quantity] += other.totals[quantity];
+    }
+    malformed += other.malformed;
+}
+
+RecordColumns RecordColumns::between(qint64 fromMs, qint64 toMs) const
+{
+    const int first = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), fromMs) - timestamps.cbegin());
+    const int last = int(std::lower_bound(timestamps.cbegin(), timestamps.cend(), toMs) - timestamps.cbegin());
+    if (first == 0 && last == size())
+        return *this;
+
+    RecordColumns result;
+    result.malformed = malformed;
+    const int rows = qMax(0, last - first);
+    result.timestamps = timestamps.mid(first, rows);
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        result.channels[channel] = channels[channel].mid(first, rows);
+    }
+    for (int quantity = 0; quantity < ChannelSchema::QuantityCount; ++quantity) {
+        result.totals[quantity] = totals[quantity].mid(first, rows);
+    }
+    return result;
+}
+
+bool RecordColumns::isSortedByTime() const
+{
+    return std::is_sorted(timestamps.cbegin(), timestamps.cend());
+}
+
+// Rows of a column in the given order; columns not filled in stay empty
+template <typename Value>
+static void permute(QVector<Value>& column, const QVector<int>& order)
+{
+    if (column.size() != order.size())
+        return;
+
+    QVector<Value> sorted(order.size());
+    for (int row = 0; row < order.size(); ++row) {
+        sorted[row] = column[order[row]];
+    }
+    column = sorted;
+}
+
+void RecordColumns::sortByTime()
+{
+    if (isSortedByTime())
+        return;
+
+    QVector<int> order(size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return timestamps[a] < timestamps[b]; });
+
+    permute(timestamps, order);
+    for (QVector<float>& column : channels) {
+        permute(column, order);
+    }
+    for (QVector<float>& column : totals) {
+        permute(column, order);
+    }
+}
+
+void RecordColumns::computeTotals()
+{
+    const int rows = size();
+
+    for (int quantity = 0; quantity < ChannelSchema::QuantityCount; ++quantity) {
+        const ChannelSchema::Quantity q = ChannelSchema::Quantity(quantity);
+        const int first = ChannelSchema::firstChannel(q);
+        const int count = ChannelSchema::channelCount(q);
+
+        QVector<float>& total = totals[quantity];
+        total.resize(rows);
+        float* out = total.data();
+
+        // Channel by channel over whole columns, no per-row dispatch
+        const float* in = channels[first].constData();
+        for (int row = 0; row < rows; ++row) {
+            out[row] = in[row];
+        }
+        for (int channel = first + 1; channel < first + count; ++channel) {
+            in = channels[channel].constData();
+            for (int row = 0; row < rows; ++row) {
+                out[row] += in[row];
+            }
+        }
+
+        if (ChannelSchema::Quantities[quantity].total == ChannelSchema::Average) {
+            const float scale = 1.0f / count;
+            for (int row = 0; row < rows; ++row) {
+                out[row] *= scale;
+            }
+        }
+    }
+}
+
+qint64 RecordColumns::memoryUsage() const
+{
+    qint64 bytes = timestamps.capacity() * qint64(sizeof(qint64));
+    for (const QVector<float>& column : channels) {
+        bytes += column.capacity() * qint64(sizeof(float));
+    }
+    for (const QVector<float>& column : totals) {
+        bytes += column.capacity() * qint64(sizeof(float));
+    }
+    return bytes;
+}
+
+// Layout of the value columns, built once
+struct ValueColumn {
+    ChannelSchema::Quantity quantity;
+    int channel;   // -1 for the quantity's total
+};
+
+static const QVector<ValueColumn>& valueColumns()
+{
+    static const QVector<ValueColumn> columns = []() {
+        QVector<ValueColumn> result;
+        for (ChannelSchema::Quantity quantity : ChannelSchema::TableQuantities) {
+            result.append({quantity, -1});
+            const int first = ChannelSchema::firstChannel(quantity);
+            for (int channel = first; channel < first + ChannelSchema::channelCount(quantity); ++channel) {
+                result.append({quantity, channel});
+            }
+        }
+        return result;
+    }();
+    return columns;
+}
+
+int RecordColumns::valueColumnCount()
+{
+    return valueColumns().size();
+}
+
+QString RecordColumns::valueColumnHeader(int column)
+{
+    const ValueColumn& info = valueColumns()[column];
+    if (info.channel >= 0)
+        return ChannelSchema::columnHeader(info.channel);
+    return ChannelSchema::totalHeader(info.quantity);
+}
+
+const QVector<float>& RecordColumns::valueColumn(int column) const
+{
+    const ValueColumn& info = valueColumns()[column];
+    return info.channel >= 0 ? channels[info.channel] : totals[info.quantity];
+}
+
+RecordColumns RecordColumns::fromNdjson(const QByteArray& lines)
+{
+    RecordColumns columns;
+    RecordStreamParser parser;
+    auto append = [&columns](const PowerSample& sample) { columns.append(sample); };
+    parser.feed(lines, append);
+    parser.finish(append);
+
+    columns.malformed = parser.malformedRecords();
+    columns.sortByTime();
+    columns.computeTotals();
+    return columns;
+}
+
+RecordColumns RecordColumns::fromJsonArray(const QByteArray& body)
+{
+    RecordColumns columns;
+    const QJsonDocument doc = QJsonDocument::fromJson(body);
+    if (!doc.isArray()) {
+        // The whole reply is unusable
+        columns.malformed = 1;
+        return columns;
+    }
+
+    const QJsonArray records = doc.array();
+    columns.reserve(records.size());
+    for (const QJsonValue& record : records) {
+        PowerSample sample;
+        if (RecordStreamParser::decodeRecord(record.toObject(), sample)) {
+            columns.append(sample);
+        } else {
+            ++columns.malformed;
+        }
+    }
+
+    columns.sortByTime();
+    columns.computeTotals();
+    return columns;
+}
+
+RecordColumns RecordColumns::fromStore(const QString& topic, qint64 fromMs, qint64 toMs)
+{
+    RecordColumns columns;
+    const SampleStore store;
+    store.query(topic, fromMs, toMs, [&columns](const PowerSample& sample) { columns.append(sample); });
+
+    columns.computeTotals();
+    return columns;
+}
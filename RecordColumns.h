@@ -0,0 +1,54 @@
+// RecordColumns.h
+#ifndef RECORDCOLUMNS_H
+#define RECORDCOLUMNS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "ChannelSchema.h"
+#include "PowerSample.h"
+
+// A batch of history records in typed columns: timestamps, one float array
+// per channel and the derived "Total" of every quantity. Batches are decoded
+// and completed on a worker thread and then appended to RecordTableModel on
+// the GUI thread, which only has to copy arrays.
+struct RecordColumns
+{
+    QVector<qint64> timestamps;
+    QVector<float> channels[ChannelSchema::ChannelCount];
+    QVector<float> totals[ChannelSchema::QuantityCount];
+    // Records that could not be decoded
+    int malformed = 0;
+
+    int size() const { return timestamps.size(); }
+    bool isEmpty() const { return timestamps.isEmpty(); }
+
+    void clear();
+    void reserve(int rows);
+    // Channels only; totals are filled in by computeTotals()
+    void append(const PowerSample& sample);
+    void append(const RecordColumns& other);
+    // Rows with a timestamp in [fromMs, toMs), for batches in time order
+    RecordColumns between(qint64 fromMs, qint64 toMs) const;
+    // The backend may answer in any order; decoded batches are sorted here,
+    // keeping the reply's order among equal timestamps
+    bool isSortedByTime() const;
+    void sortByTime();
+    // Derives every quantity's total from its channels, one column at a time
+    // so the loops run over contiguous arrays and vectorize
+    void computeTotals();
+    qint64 memoryUsage() const;
+
+    // Value columns of tables and exports, after the timestamp: for each
+    // ChannelSchema::TableQuantities group its total, then its channels
+    static int valueColumnCount();
+    static QString valueColumnHeader(int column);
+    const QVector<float>& valueColumn(int column) const;
+
+    // Complete batches, totals included. Safe to run on any thread.
+    static RecordColumns fromNdjson(const QByteArray& lines);
+    static RecordColumns fromJsonArray(const QByteArray& body);
+    static RecordColumns fromStore(const QString& topic, qint64 fromMs, qint64 toMs);
+};
+
+#endif // RECORDCOLUMNS_H
@@ -0,0 +1,106 @@
+// RecordStreamParser.cpp
+#include "RecordStreamParser.h"
+#include <QDateTime>
+#include <QJsonDocument>
+
+void RecordStreamParser::feed(const QByteArray& chunk, const Visitor& visitor)
+{
+    int lineStart = 0;
+    int newline = chunk.indexOf('\n');
+
+    // Complete the line left over from the previous chunk first
+    if (!m_partialLine.isEmpty()) {
+        if (newline < 0) {
+            m_partialLine += chunk;
+            return;
+        }
+        m_partialLine += QByteArray::fromRawData(chunk.constData(), newline);
+        decodeLine(m_partialLine.constData(), m_partialLine.size(), visitor);
+        m_partialLine.clear();
+        lineStart = newline + 1;
+        newline = chunk.indexOf('\n', lineStart);
+    }
+
+    while (newline >= 0) {
+        decodeLine(chunk.constData() + lineStart, newline - lineStart, visitor);
+        lineStart = newline + 1;
+        newline = chunk.indexOf('\n', lineStart);
+    }
+
+    m_partialLine = chunk.mid(lineStart);
+}
+
+void RecordStreamParser::finish(const Visitor& visitor)
+{
+    if (!m_partialLine.isEmpty()) {
+        decodeLine(m_partialLine.constData(), m_partialLine.size(), visitor);
+        m_partialLine.clear();
+    }
+}
+
+QByteArray RecordStreamParser::takeCompleteLines(const QByteArray& chunk)
+{
+    const int lastNewline = chunk.lastIndexOf('\n');
+    if (lastNewline < 0) {
+        m_partialLine += chunk;
+        return QByteArray();
+    }
+
+    QByteArray lines = m_partialLine + chunk.left(lastNewline + 1);
+    m_partialLine = chunk.mid(lastNewline + 1);
+    return lines;
+}
+
+QByteArray RecordStreamParser::takeRemainder()
+{
+    QByteArray remainder = m_partialLine;
+    m_partialLine.clear();
+    return remainder;
+}
+
+void RecordStreamParser::reset()
+{
+    m_partialLine.clear();
+    m_malformedRecords = 0;
+}
+
+void RecordStreamParser::decodeLine(const char* data, int size, const Visitor& visitor)
+{
+    const QByteArray line = QByteArray::fromRawData(data, size).trimmed();
+    if (line.isEmpty())
+        return;
+
+    PowerSample sample;
+    const QJsonDocument doc = QJsonDocument::fromJson(line);
+    if (!doc.isObject() || !decodeRecord(doc.object(), sample)) {
+        ++m_malformedRecords;
+        return;
+    }
+    visitor(sample);
+}
+
+bool RecordStreamParser::decodeRecord(const QJsonObject& record, PowerSample& sample)
+{
+    if (!decodeTimestamp(record.value(QLatin1String("timestamp")), sample.timestampMs))
+        return false;
+
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        sample.values[channel] = record.value(QLatin1String(ChannelSchema::Channels[channel].key)).toDouble();
+    }
+    return true;
+}
+
+bool RecordStreamParser::decodeTimestamp(const QJsonValue& value, qint64& timestampMs)
+{
+    if (value.isString()) {
+        const QDateTime time = QDateTime::fromString(value.toString(), Qt::ISODateWithMs);
+        if (!time.isValid())
+            return false;
+        timestampMs = time.toMSecsSinceEpoch();
+    } else if (value.isDouble()) {
+        timestampMs = qint64(value.toDouble());
+    } else {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+// RecordStreamParser.h
+#ifndef RECORDSTREAMPARSER_H
+#define RECORDSTREAMPARSER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <functional>
+#include "PowerSample.h"
+
+// Incremental parser for /recordData replies in NDJSON form: one JSON record
+// per line, {"timestamp":"<ISO 8601>" or <ms since epoch>, "v1":..., ..., "p3":...}.
+// Chunks are fed as they arrive from the network; every complete line is
+// decoded straight away and only the trailing partial line is kept, so memory
+// does not grow with the length of the reply. Alternatively the reply can
+// just be cut into runs of complete lines with takeCompleteLines(), to be
+// decoded elsewhere (see RecordColumns::fromNdjson()).
+class RecordStreamParser
+{
+public:
+    using Visitor = std::function<void(const PowerSample&)>;
+
+    void feed(const QByteArray& chunk, const Visitor& visitor);
+    // End of the reply: decodes a last record not terminated by a newline
+    void finish(const Visitor& visitor);
+    void reset();
+
+    // Everything up to the last newline received so far, including what was
+    // held over from earlier chunks; the rest is kept for the next call
+    QByteArray takeCompleteLines(const QByteArray& chunk);
+    // The unterminated tail, at the end of the reply
+    QByteArray takeRemainder();
+
+    int malformedRecords() const { return m_malformedRecords; }
+
+    // Also used for the elements of legacy whole-array replies. Channels
+    // missing from the record read as 0, as they always have.
+    static bool decodeRecord(const QJsonObject& record, PowerSample& sample);
+    // "<ISO 8601>" or ms since epoch
+    static bool decodeTimestamp(const QJsonValue& value, qint64& timestampMs);
+
+private:
+    void decodeLine(const char* data, int size, const Visitor& visitor);
+
+    QByteArray m_partialLine;
+    int m_malformedRecords = 0;
+};
+
+#endif // RECORDSTREAMPARSER_H
@@ -0,0 +1,86 @@
+// RecordTableModel.cpp
+#include "RecordTableModel.h"
+#include <QDateTime>
+
+RecordTableModel::RecordTableModel(QObject* parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+void RecordTableModel::clear()
+{
+    beginResetModel();
+    m_records.clear();
+    endResetModel();
+}
+
+void RecordTableModel::appendColumns(const RecordColumns& batch)
+{
+    if (batch.isEmpty())
+        return;
+
+    const int first = m_records.size();
+    beginInsertRows(QModelIndex(), first, first + batch.size() - 1);
+    m_records.append(batch);
+    endInsertRows();
+}
+
+void RecordTableModel::sortByTime()
+{
+    if (m_records.isSortedByTime())
+        return;
+
+    beginResetModel();
+    m_records.sortByTime();
+    endResetModel();
+}
+
+QString RecordTableModel::cellText(int row, int column) const
+{
+    if (column == 0)
+        return QDateTime::fromMSecsSinceEpoch(m_records.timestamps[row]).toString(Qt::ISODate);
+
+    return QString::number(m_records.valueColumn(column - 1)[row], 'f', 2);
+}
+
+QString RecordTableModel::headerText(int column) const
+{
+    if (column == 0)
+        return QString("Timestamp");
+
+    return RecordColumns::valueColumnHeader(column - 1);
+}
+
+int RecordTableModel::rowCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : m_records.size();
+}
+
+int RecordTableModel::columnCount(const QModelIndex& parent) const
+{
+    return parent.isValid() ? 0 : 1 + RecordColumns::valueColumnCount();
+}
+
+QVariant RecordTableModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_records.size())
+        return QVariant();
+
+    if (role == Qt::DisplayRole)
+        return cellText(index.row(), index.column());
+
+    if (role == Qt::TextAlignmentRole && index.column() > 0)
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+
+    return QVariant();
+}
+
+QVariant RecordTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (orientation == Qt::Horizontal)
+        return headerText(section);
+    return section + 1;
+}
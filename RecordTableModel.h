@@ -0,0 +1,47 @@
+// RecordTableModel.h
+#ifndef RECORDTABLEMODEL_H
+#define RECORDTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include "ChannelSchema.h"
+#include "RecordColumns.h"
+
+// Fetched history of one location for DataRecordDialog. Records are kept in
+// typed columns (RecordColumns: timestamps, channels and precomputed totals,
+// about 56 bytes a row) and cells are only formatted when data() asks for
+// them, so a multi-million-row result costs no per-cell objects at all.
+// Columns are the timestamp followed, for each ChannelSchema::TableQuantities
+// group, by the group's total and its channels.
+class RecordTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit RecordTableModel(QObject* parent = nullptr);
+
+    void clear();
+    // One rowsInserted() per batch; the batch's totals must be computed
+    void appendColumns(const RecordColumns& batch);
+    // Batches are sorted, but may arrive out of order among themselves
+    void sortByTime();
+
+    const RecordColumns& records() const { return m_records; }
+    qint64 timestampAt(int row) const { return m_records.timestamps[row]; }
+    float valueAt(int row, int channel) const { return m_records.channels[channel][row]; }
+    qint64 memoryUsage() const { return m_records.memoryUsage(); }
+
+    // Text of a cell and a header, as shown in the table and exported
+    QString cellText(int row, int column) const;
+    QString headerText(int column) const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    RecordColumns m_records;
+};
+
+#endif // RECORDTABLEMODEL_H
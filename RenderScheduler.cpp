@@ -0,0 +1,114 @@
+// RenderScheduler.cpp
+#include "RenderScheduler.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QScrollBar>
+
+RenderScheduler* RenderScheduler::instance()
+{
+    // Owned by the application so it goes away with the GUI thread
+    static RenderScheduler* scheduler = new RenderScheduler(QCoreApplication::instance());
+    return scheduler;
+}
+
+RenderScheduler::RenderScheduler(QObject* parent)
+    : QObject(parent),
+    m_maxFrameRate(DEFAULT_FRAME_RATE)
+{
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &RenderScheduler::renderFrame);
+    m_sinceLastFrame.start();
+}
+
+void RenderScheduler::setMaxFrameRate(int fps)
+{
+    m_maxFrameRate = qBound(1, fps, 240);
+}
+
+void RenderScheduler::addTarget(QWidget* view, std::function<void()> render)
+{
+    m_targets.append({view, render, false});
+
+    // Showing a view (e.g. switching stack pages) renders its pending data
+    view->installEventFilter(this);
+}
+
+void RenderScheduler::removeTarget(QWidget* view)
+{
+    for (int i = m_targets.size() - 1; i >= 0; --i) {
+        if (m_targets[i].view == view || m_targets[i].view.isNull()) {
+            m_targets.removeAt(i);
+        }
+    }
+    if (view) {
+        view->removeEventFilter(this);
+    }
+}
+
+void RenderScheduler::markDirty(QWidget* view)
+{
+    for (Target& target : m_targets) {
+        if (target.view == view) {
+            target.dirty = true;
+        }
+    }
+    requestFrame();
+}
+
+void RenderScheduler::requestFrame()
+{
+    if (m_frameTimer.isActive())
+        return;
+
+    // Wait out the rest of the current frame slot, then render
+    const qint64 frameInterval = 1000 / m_maxFrameRate;
+    const qint64 remaining = frameInterval - m_sinceLastFrame.elapsed();
+    m_frameTimer.start(int(qMax<qint64>(0, remaining)));
+}
+
+void RenderScheduler::watchScrolling(QAbstractScrollArea* area)
+{
+    // Scrolling doesn't show or hide anything, it only changes what is exposed
+    connect(area->verticalScrollBar(), &QScrollBar::valueChanged, this, &RenderScheduler::requestFrame);
+    connect(area->horizontalScrollBar(), &QScrollBar::valueChanged, this, &RenderScheduler::requestFrame);
+}
+
+bool RenderScheduler::isOnScreen(const QWidget* view)
+{
+    // visibleRegion() is clipped by every ancestor, including scroll area viewports
+    return view->isVisible() && !view->visibleRegion().isEmpty();
+}
+
+bool RenderScheduler::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Show || event->type() == QEvent::Resize) {
+        for (const Target& target : m_targets) {
+            if (target.view == watched && target.dirty) {
+                requestFrame();
+                break;
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void RenderScheduler::renderFrame()
+{
+    m_sinceLastFrame.restart();
+
+    for (int i = 0; i < m_targets.size(); ++i) {
+        Target& target = m_targets[i];
+        if (target.view.isNull()) {
+            m_targets.removeAt(i--);
+            continue;
+        }
+
+        // Hidden and scrolled-away views keep their dirty flag until they are on screen again
+        if (!target.dirty || !isOnScreen(target.view))
+            continue;
+
+        target.dirty = false;
+        target.render();
+    }
+}
@@ -0,0 +1,66 @@
+// RenderScheduler.h
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+#include <QWidget>
+#include <QAbstractScrollArea>
+#include <functional>
+
+// Decouples ingest rate from render rate. Views are marked dirty whenever
+// their data changes; at most maxFrameRate() times per second the scheduler
+// runs the render callback of every dirty view that is actually on screen.
+// Hidden views (e.g. other stack pages) and views scrolled out of their scroll
+// area stay dirty, and are rendered as soon as they are shown or scrolled back
+// into view; their data keeps being recorded meanwhile.
+class RenderScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    static RenderScheduler* instance();
+
+    void setMaxFrameRate(int fps);
+    int maxFrameRate() const { return m_maxFrameRate; }
+
+    void addTarget(QWidget* view, std::function<void()> render);
+    void removeTarget(QWidget* view);
+    void markDirty(QWidget* view);
+
+    // Schedule a frame without dirtying anything, e.g. after a view was shown
+    // or scrolled into view
+    void requestFrame();
+
+    // Views inside the area get a frame whenever it scrolls
+    void watchScrolling(QAbstractScrollArea* area);
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private slots:
+    void renderFrame();
+
+private:
+    explicit RenderScheduler(QObject* parent = nullptr);
+
+    static bool isOnScreen(const QWidget* view);
+
+    struct Target {
+        QPointer<QWidget> view;
+        std::function<void()> render;
+        bool dirty;
+    };
+
+    static const int DEFAULT_FRAME_RATE = 30;
+
+    QVector<Target> m_targets;
+    QTimer m_frameTimer;
+    QElapsedTimer m_sinceLastFrame;
+    int m_maxFrameRate;
+};
+
+#endif // RENDERSCHEDULER_H
@@ -0,0 +1,64 @@
+// SampleBus.cpp
+#include "SampleBus.h"
+
+SampleBus::SampleBus(QObject* parent)
+    : QObject(parent)
+{
+}
+
+int SampleBus::subscribe(int topicId, QObject* owner, Handler handler)
+{
+    if (topicId < 0)
+        return -1;
+
+    if (m_subscribers.size() <= topicId) {
+        m_subscribers.resize(topicId + 1);
+    }
+
+    const int subscriptionId = m_nextSubscriptionId++;
+    m_subscribers[topicId].append({subscriptionId, owner, handler});
+    return subscriptionId;
+}
+
+void SampleBus::unsubscribe(int subscriptionId)
+{
+    for (QVector<Subscriber>& subscribers : m_subscribers) {
+        for (int i = 0; i < subscribers.size(); ++i) {
+            if (subscribers[i].id == subscriptionId) {
+                subscribers.removeAt(i);
+                return;
+            }
+        }
+    }
+}
+
+void SampleBus::unsubscribeAll(QObject* owner)
+{
+    for (QVector<Subscriber>& subscribers : m_subscribers) {
+        for (int i = subscribers.size() - 1; i >= 0; --i) {
+            if (subscribers[i].owner == owner || subscribers[i].owner.isNull()) {
+                subscribers.removeAt(i);
+            }
+        }
+    }
+}
+
+void SampleBus::publish(const PowerSample& sample)
+{
+    if (sample.topicId < 0 || sample.topicId >= m_subscribers.size())
+        return;
+
+    QVector<Subscriber>& subscribers = m_subscribers[sample.topicId];
+    for (int i = 0; i < subscribers.size(); ++i) {
+        if (subscribers[i].owner.isNull()) {
+            subscribers.removeAt(i--);
+            continue;
+        }
+        subscribers[i].handler(sample);
+    }
+}
+
+void SampleBus::endBatch()
+{
+    emit batchPublished();
+}
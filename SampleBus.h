@@ -0,0 +1,50 @@
+// SampleBus.h
+#ifndef SAMPLEBUS_H
+#define SAMPLEBUS_H
+
+#include <QObject>
+#include <QPointer>
+#include <QVector>
+#include <functional>
+#include "PowerSample.h"
+
+// GUI-thread publish/subscribe bus for decoded samples. Every frame is decoded
+// exactly once on the ingest thread; charts, gauges, recorders and alarms all
+// subscribe here instead of reading socket text. Handlers get a const
+// reference straight into the ingest queue slot, so publishing never copies
+// the sample; the reference is only valid for the duration of the call.
+class SampleBus : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Handler = std::function<void(const PowerSample&)>;
+
+    explicit SampleBus(QObject* parent = nullptr);
+
+    // Returns a subscription id for unsubscribe(). Subscriptions whose owner
+    // has been destroyed are skipped and dropped automatically.
+    int subscribe(int topicId, QObject* owner, Handler handler);
+    void unsubscribe(int subscriptionId);
+    void unsubscribeAll(QObject* owner);
+
+    void publish(const PowerSample& sample);
+    void endBatch();
+
+signals:
+    // Emitted once after every published batch, so subscribers can coalesce
+    // their UI work instead of reacting to each sample
+    void batchPublished();
+
+private:
+    struct Subscriber {
+        int id;
+        QPointer<QObject> owner;
+        Handler handler;
+    };
+
+    QVector<QVector<Subscriber>> m_subscribers;   // indexed by topic id
+    int m_nextSubscriptionId = 0;
+};
+
+#endif // SAMPLEBUS_H
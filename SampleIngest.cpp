@@ -0,0 +1,319 @@
+// SampleIngest.cpp
+#include "SampleIngest.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <cstring>
+
+IngestWorker::IngestWorker(SpscQueue<PowerSample>* queue, std::atomic<bool>* pending)
+    : QObject(nullptr),
+    m_queue(queue),
+    m_pending(pending)
+{
+}
+
+void IngestWorker::open(const QUrl& url)
+{
+    m_url = url;
+
+    // Parented to the worker so the socket lives (and dies) on the ingest thread
+    m_socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(m_socket, &QWebSocket::connected, this, &IngestWorker::onConnected);
+    connect(m_socket, &QWebSocket::disconnected, this, &IngestWorker::onDisconnected);
+    connect(m_socket, &QWebSocket::textMessageReceived, this, &IngestWorker::onTextMessageReceived);
+    connect(m_socket, &QWebSocket::binaryMessageReceived, this, &IngestWorker::onBinaryMessageReceived);
+    connect(m_socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this, &IngestWorker::onError);
+
+    // With a single shared connection, losing it would stall every topic
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    m_reconnectTimer->setInterval(RECONNECT_INTERVAL_MS);
+    connect(m_reconnectTimer, &QTimer::timeout, this, [this]() { m_socket->open(m_url); });
+
+    // Samples are buffered per topic and hit the disk about once a second
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setInterval(STORE_FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, [this]() { m_store.flush(); });
+    m_flushTimer->start();
+
+    // Old segments are deleted now and then, and once at startup
+    m_sweepTimer = new QTimer(this);
+    m_sweepTimer->setInterval(STORE_SWEEP_INTERVAL_MS);
+    connect(m_sweepTimer, &QTimer::timeout, this, [this]() { m_store.sweep(); });
+    m_sweepTimer->start();
+    m_store.sweep();
+
+    m_socket->open(m_url);
+}
+
+void IngestWorker::subscribe(int topicId, const QString& topic)
+{
+    m_topicIds[topic] = topicId;
+    m_topicNames[topicId] = topic;
+
+    QJsonObject message;
+    message["op"] = "subscribe";
+    message["topic"] = topic;
+    message["id"] = topicId;
+    sendControl(message);
+}
+
+void IngestWorker::unsubscribe(int topicId, const QString& topic)
+{
+    m_topicIds.remove(topic);
+    m_topicNames.remove(topicId);
+    m_store.endSpan(topic);
+
+    QJsonObject message;
+    message["op"] = "unsubscribe";
+    message["topic"] = topic;
+    message["id"] = topicId;
+    sendControl(message);
+}
+
+bool IngestWorker::sendCommand(const QString& topic, const QString& command)
+{
+    if (!m_socket || !m_socket->isValid())
+        return false;
+
+    QJsonObject message;
+    message["op"] = "command";
+    message["topic"] = topic;
+    message["command"] = command;
+    sendControl(message);
+    return true;
+}
+
+void IngestWorker::setStoreRetention(qint64 retentionMs)
+{
+    m_store.setRetention(retentionMs);
+    m_store.sweep();
+}
+
+void IngestWorker::sendControl(const QJsonObject& message)
+{
+    // Before the socket is up this is a no-op; onConnected() replays subscriptions
+    if (m_socket && m_socket->isValid()) {
+        m_socket->sendTextMessage(QString::fromUtf8(QJsonDocument(message).toJson(QJsonDocument::Compact)));
+    }
+}
+
+void IngestWorker::onConnected()
+{
+    qDebug() << "WebSocket connected to" << m_url.toString() << "-" << m_topicIds.size() << "topics";
+
+    for (auto it = m_topicIds.constBegin(); it != m_topicIds.constEnd(); ++it) {
+        QJsonObject message;
+        message["op"] = "subscribe";
+        message["topic"] = it.key();
+        message["id"] = it.value();
+        sendControl(message);
+    }
+}
+
+void IngestWorker::onDisconnected()
+{
+    qDebug() << "WebSocket disconnected from" << m_url.toString() << "- retrying";
+
+    // Whatever is sent until we are back is missing locally
+    m_store.endSpans();
+    m_reconnectTimer->start();
+}
+
+void IngestWorker::onError(QAbstractSocket::SocketError error)
+{
+    qDebug() << "WebSocket error on" << m_url.toString() << error;
+}
+
+void IngestWorker::onTextMessageReceived(const QString& message)
+{
+    PowerSample sample;
+    sample.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    if (!decodeJson(message, sample)) {
+        qDebug() << "Error: Invalid or incomplete JSON message received";
+        return;
+    }
+
+    publish(sample);
+}
+
+void IngestWorker::onBinaryMessageReceived(const QByteArray& message)
+{
+    if (message.isEmpty() || message.size() % BINARY_RECORD_SIZE != 0) {
+        qDebug() << "Error: Malformed binary frame of" << message.size() << "bytes";
+        return;
+    }
+
+    const qint64 receivedMs = QDateTime::currentMSecsSinceEpoch();
+    const char* data = message.constData();
+    const int records = message.size() / BINARY_RECORD_SIZE;
+
+    for (int i = 0; i < records; ++i) {
+        PowerSample sample;
+        decodeBinaryRecord(data + i * BINARY_RECORD_SIZE, sample);
+
+        // Drop records for topics we no longer subscribe to
+        if (!m_topicNames.contains(sample.topicId)) {
+            continue;
+        }
+        if (sample.timestampMs == 0) {
+            sample.timestampMs = receivedMs;
+        }
+        publish(sample);
+    }
+}
+
+void IngestWorker::decodeBinaryRecord(const char* record, PowerSample& sample)
+{
+    sample.timestampMs = qFromLittleEndian<qint64>(record);
+    sample.topicId = qFromLittleEndian<quint16>(record + 8);
+
+    // Values are positional, in schema order
+    const char* values = record + BINARY_RECORD_HEADER_SIZE;
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        const quint32 bits = qFromLittleEndian<quint32>(values + channel * 4);
+        std::memcpy(&sample.values[channel], &bits, sizeof(float));
+    }
+}
+
+bool IngestWorker::decodeJson(const QString& message, PowerSample& sample) const
+{
+    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
+    if (doc.isNull() || !doc.isObject()) {
+        return false;
+    }
+
+    const QJsonObject obj = doc.object();
+
+    // One pass over the object's members instead of a lookup per channel
+    quint64 seen = 0;
+    sample.topicId = -1;
+    for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        const int channel = ChannelSchema::channelForKey(it.key());
+        if (channel >= 0) {
+            sample.values[channel] = it.value().toDouble();
+            seen |= quint64(1) << channel;
+        } else if (it.key() == QLatin1String("topic")) {
+            sample.topicId = m_topicIds.value(it.value().toString(), -1);
+        }
+    }
+
+    const quint64 allChannels = (quint64(1) << ChannelSchema::ChannelCount) - 1;
+    return sample.topicId >= 0 && seen == allChannels;
+}
+
+void IngestWorker::publish(const PowerSample& sample)
+{
+    // Stored even when the GUI thread is behind and the sample is dropped below
+    m_store.append(m_topicNames.value(sample.topicId), sample);
+
+    if (!m_queue->push(sample)) {
+        // GUI thread is behind; drop rather than block the socket thread
+        if ((m_droppedSamples++ % 1000) == 0) {
+            qWarning() << "Ingest queue full, dropped" << m_droppedSamples << "samples";
+        }
+        return;
+    }
+
+    // Only wake the GUI thread once per batch; dispatchSamples() clears the flag again
+    if (!m_pending->exchange(true, std::memory_order_acq_rel)) {
+        emit samplesReady();
+    }
+}
+
+SampleIngest* SampleIngest::forBackend(const QUrl& url)
+{
+    // One manager (and so one connection) per backend, shared by all clusters
+    static QHash<QString, SampleIngest*> managers;
+
+    const QString key = url.toString();
+    SampleIngest* manager = managers.value(key);
+    if (!manager) {
+        manager = new SampleIngest(url, QCoreApplication::instance());
+        managers.insert(key, manager);
+    }
+    return manager;
+}
+
+SampleIngest::SampleIngest(const QUrl& url, QObject* parent)
+    : QObject(parent),
+    m_queue(QUEUE_CAPACITY),
+    m_pending(false)
+{
+    m_worker = new IngestWorker(&m_queue, &m_pending);
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    // Cross-thread connections are queued automatically
+    connect(m_worker, &IngestWorker::samplesReady, this, &SampleIngest::dispatchSamples);
+
+    m_thread.setObjectName("SampleIngest");
+    m_thread.start();
+
+    QMetaObject::invokeMethod(m_worker, "open", Qt::QueuedConnection, Q_ARG(QUrl, url));
+}
+
+SampleIngest::~SampleIngest()
+{
+    m_thread.quit();
+    m_thread.wait();
+}
+
+int SampleIngest::subscribe(const QString& topic)
+{
+    int topicId = m_topicIds.value(topic, -1);
+    if (topicId < 0) {
+        topicId = m_topicNames.size();
+        m_topicIds.insert(topic, topicId);
+        m_topicNames.append(topic);
+        m_refCounts.append(0);
+    }
+
+    if (m_refCounts[topicId]++ == 0) {
+        QMetaObject::invokeMethod(m_worker, "subscribe", Qt::QueuedConnection,
+                                  Q_ARG(int, topicId), Q_ARG(QString, topic));
+    }
+    return topicId;
+}
+
+void SampleIngest::unsubscribe(int topicId)
+{
+    if (topicId < 0 || topicId >= m_refCounts.size() || m_refCounts[topicId] == 0)
+        return;
+
+    if (--m_refCounts[topicId] == 0) {
+        QMetaObject::invokeMethod(m_worker, "unsubscribe", Qt::QueuedConnection,
+                                  Q_ARG(int, topicId), Q_ARG(QString, m_topicNames[topicId]));
+    }
+}
+
+bool SampleIngest::sendCommand(int topicId, const QString& command)
+{
+    // The socket belongs to the ingest thread, which never waits on the GUI
+    // thread, so blocking briefly here is safe
+    bool sent = false;
+    QMetaObject::invokeMethod(m_worker, "sendCommand", Qt::BlockingQueuedConnection, Q_RETURN_ARG(bool, sent),
+                              Q_ARG(QString, topicName(topicId)), Q_ARG(QString, command));
+    return sent;
+}
+
+void SampleIngest::setStoreRetention(qint64 retentionMs)
+{
+    QMetaObject::invokeMethod(m_worker, "setStoreRetention", Qt::QueuedConnection, Q_ARG(qint64, retentionMs));
+}
+
+void SampleIngest::dispatchSamples()
+{
+    m_pending.store(false, std::memory_order_release);
+
+    // Samples are published straight out of their queue slots, without copies
+    const size_t drained = m_queue.drain([this](const PowerSample& sample) {
+        m_bus.publish(sample);
+    });
+
+    if (drained > 0) {
+        m_bus.endBatch();
+    }
+}
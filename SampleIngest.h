@@ -0,0 +1,140 @@
+// SampleIngest.h
+#ifndef SAMPLEINGEST_H
+#define SAMPLEINGEST_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QJsonObject>
+#include <QtWebSockets/QWebSocket>
+#include <atomic>
+#include "PowerSample.h"
+#include "SampleBus.h"
+#include "SampleStore.h"
+#include "SpscQueue.h"
+
+// Wire protocol of the multiplexed /ws endpoint.
+//
+// Client -> server (text):
+//   {"op":"subscribe",   "topic":"<name>", "id":<topic id>}
+//   {"op":"unsubscribe", "topic":"<name>", "id":<topic id>}
+//   {"op":"command",     "topic":"<name>", "command":"MOTOR ON"}
+//
+// Server -> client, either a JSON text frame carrying the topic name
+//   {"topic":"<name>", "v1":..., "v2":..., ..., "p3":...}
+// or a compact binary frame: one or more fixed-size little-endian records
+//   offset  0  qint64    timestamp, ms since epoch (0 = stamp on receipt)
+//   offset  8  quint16   topic id, as sent in the subscribe message
+//   offset 10  quint16   reserved, 0
+//   offset 12  float32   one value per ChannelSchema channel, in schema order
+//                        (v1 v2 v3 c1 c2 c3 p1 p2 p3 -> 48-byte records)
+static const int BINARY_RECORD_HEADER_SIZE = 12;
+static const int BINARY_RECORD_SIZE = BINARY_RECORD_HEADER_SIZE + 4 * ChannelSchema::ChannelCount;
+
+// Lives on the ingest thread. Owns the backend's single websocket, keeps the
+// backend's subscriptions in sync and turns every frame into PowerSamples
+// pushed onto the shared queue. Every decoded sample is also appended to the
+// local SampleStore, so the disk write never touches the GUI thread; a lost
+// connection or subscription ends the store's coverage span of the topic.
+class IngestWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    IngestWorker(SpscQueue<PowerSample>* queue, std::atomic<bool>* pending);
+
+public slots:
+    void open(const QUrl& url);
+    void subscribe(int topicId, const QString& topic);
+    void unsubscribe(int topicId, const QString& topic);
+    // False if the connection is down and nothing was sent
+    bool sendCommand(const QString& topic, const QString& command);
+    void setStoreRetention(qint64 retentionMs);
+
+signals:
+    void samplesReady();
+
+private slots:
+    void onConnected();
+    void onDisconnected();
+    void onTextMessageReceived(const QString& message);
+    void onBinaryMessageReceived(const QByteArray& message);
+    void onError(QAbstractSocket::SocketError error);
+
+private:
+    static const int RECONNECT_INTERVAL_MS = 3000;
+    static const int STORE_FLUSH_INTERVAL_MS = 1000;
+    static const int STORE_SWEEP_INTERVAL_MS = 60 * 60 * 1000;
+
+    void sendControl(const QJsonObject& message);
+    bool decodeJson(const QString& message, PowerSample& sample) const;
+    static void decodeBinaryRecord(const char* record, PowerSample& sample);
+    void publish(const PowerSample& sample);
+
+    SpscQueue<PowerSample>* m_queue;
+    std::atomic<bool>* m_pending;
+    QWebSocket* m_socket = nullptr;
+    QTimer* m_reconnectTimer = nullptr;
+    QTimer* m_flushTimer = nullptr;
+    QTimer* m_sweepTimer = nullptr;
+    SampleStore m_store;
+    QUrl m_url;
+    // Active subscriptions, replayed on every (re)connect
+    QHash<QString, int> m_topicIds;
+    QHash<int, QString> m_topicNames;
+    int m_droppedSamples = 0;
+};
+
+// GUI-side subscription manager for one backend. Every topic is subscribed on
+// the backend at most once no matter how many consumers want it; frames are
+// decoded once on the ingest thread and published on bus() to every
+// subscriber of the topic. Shared instances are obtained through forBackend().
+class SampleIngest : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SampleIngest* forBackend(const QUrl& url = QUrl("ws://localhost:8080/ws"));
+    ~SampleIngest();
+
+    // Reference counted: the first subscribe() of a topic subscribes it on
+    // the backend and the last unsubscribe() releases it again. Topic ids are
+    // stable for the lifetime of the manager.
+    int subscribe(const QString& topic);
+    void unsubscribe(int topicId);
+    QString topicName(int topicId) const { return m_topicNames.value(topicId); }
+
+    // Waits for the ingest thread to hand the command to the socket; false,
+    // and nothing is sent, while the connection is down
+    bool sendCommand(int topicId, const QString& command);
+
+    // How long the local store keeps samples on disk; see SampleStore
+    void setStoreRetention(qint64 retentionMs);
+
+    SampleBus* bus() { return &m_bus; }
+
+private slots:
+    void dispatchSamples();
+
+private:
+    SampleIngest(const QUrl& url, QObject* parent);
+
+    static const int QUEUE_CAPACITY = 4096;
+
+    QThread m_thread;
+    IngestWorker* m_worker;
+    SpscQueue<PowerSample> m_queue;
+    std::atomic<bool> m_pending;
+    SampleBus m_bus;
+
+    QHash<QString, int> m_topicIds;
+    QStringList m_topicNames;
+    QVector<int> m_refCounts;
+};
+
+#endif // SAMPLEINGEST_H
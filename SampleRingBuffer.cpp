@@ -0,0 +1,106 @@
+// SampleRingBuffer.cpp
+#include "SampleRingBuffer.h"
+
+SampleRingBuffer::SampleRingBuffer(int capacity)
+    : m_capacity(qMax(1, capacity))
+{
+    m_timestamps.resize(m_capacity);
+    for (QVector<float>& column : m_columns) {
+        column.resize(m_capacity);
+    }
+}
+
+void SampleRingBuffer::append(const PowerSample& sample)
+{
+    int slot;
+    if (m_size < m_capacity) {
+        slot = physicalIndex(m_size);
+        ++m_size;
+    } else {
+        // Full: overwrite the oldest slot and advance the head past it
+        slot = m_head;
+        m_head = (m_head + 1 == m_capacity) ? 0 : m_head + 1;
+    }
+
+    m_timestamps[slot] = sample.timestampMs;
+    for (int column = 0; column < ColumnCount; ++column) {
+        m_columns[column][slot] = sample.values[column];
+    }
+}
+
+void SampleRingBuffer::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
+
+void SampleRingBuffer::setCapacity(int capacity)
+{
+    capacity = qMax(1, capacity);
+    if (capacity == m_capacity)
+        return;
+
+    // Copy the newest samples that fit, oldest first, into fresh columns
+    const int kept = qMin(m_size, capacity);
+    const int first = m_size - kept;
+
+    QVector<qint64> timestamps(capacity);
+    for (int i = 0; i < kept; ++i) {
+        timestamps[i] = timestampAt(first + i);
+    }
+    for (QVector<float>& column : m_columns) {
+        QVector<float> resized(capacity);
+        for (int i = 0; i < kept; ++i) {
+            int physical = m_head + first + i;
+            resized[i] = column[physical >= m_capacity ? physical - m_capacity : physical];
+        }
+        column.swap(resized);
+    }
+    m_timestamps.swap(timestamps);
+
+    m_capacity = capacity;
+    m_head = 0;
+    m_size = kept;
+}
+
+void SampleRingBuffer::dropOldest(int count)
+{
+    count = qBound(0, count, m_size);
+    m_head = physicalIndex(count);
+    m_size -= count;
+    if (m_size == 0) {
+        m_head = 0;
+    }
+}
+
+int SampleRingBuffer::lowerBound(qint64 timestampMs) const
+{
+    int low = 0;
+    int high = m_size;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (timestampAt(middle) < timestampMs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+void SampleRingBuffer::toPoints(int column, QList<QPointF>& points, int first) const
+{
+    first = qBound(0, first, m_size);
+    points.resize(m_size - first);
+
+    const qint64* timestamps = m_timestamps.constData();
+    const float* values = m_columns[column].constData();
+
+    // The live region is at most two contiguous spans of the ring
+    const int firstSpan = qMin(m_size, m_capacity - m_head);
+    for (int i = first; i < firstSpan; ++i) {
+        points[i - first] = QPointF(timestamps[m_head + i], values[m_head + i]);
+    }
+    for (int i = qMax(first, firstSpan); i < m_size; ++i) {
+        points[i - first] = QPointF(timestamps[i - firstSpan], values[i - firstSpan]);
+    }
+}
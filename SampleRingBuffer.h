@@ -0,0 +1,66 @@
+// SampleRingBuffer.h
+#ifndef SAMPLERINGBUFFER_H
+#define SAMPLERINGBUFFER_H
+
+#include <QVector>
+#include <QList>
+#include <QPointF>
+#include "PowerSample.h"
+
+// Structure-of-arrays history for one location: a timestamp column plus one
+// float column per ChannelSchema channel. Storage is allocated up front for
+// the current capacity, so append() is O(1) and never allocates; once the
+// buffer is full the oldest sample is overwritten. The owner can resize the
+// buffer and drop its oldest samples to implement time-based retention.
+class SampleRingBuffer
+{
+public:
+    // Columns are indexed by ChannelSchema::Channel
+    static constexpr int ColumnCount = ChannelSchema::ChannelCount;
+    static constexpr int BytesPerSample = sizeof(qint64) + ColumnCount * sizeof(float);
+
+    explicit SampleRingBuffer(int capacity);
+
+    void append(const PowerSample& sample);
+    void clear();
+
+    // Reallocates to the given capacity, keeping the newest samples that fit
+    void setCapacity(int capacity);
+    void dropOldest(int count);
+    void dropBefore(qint64 timestampMs) { dropOldest(lowerBound(timestampMs)); }
+
+    int size() const { return m_size; }
+    int capacity() const { return m_capacity; }
+    bool isEmpty() const { return m_size == 0; }
+    bool isFull() const { return m_size == m_capacity; }
+    qint64 memoryUsage() const { return qint64(m_capacity) * BytesPerSample; }
+
+    // Logical index: 0 is the oldest retained sample, size() - 1 the newest
+    qint64 timestampAt(int index) const { return m_timestamps[physicalIndex(index)]; }
+    float valueAt(int column, int index) const { return m_columns[column][physicalIndex(index)]; }
+    qint64 firstTimestamp() const { return timestampAt(0); }
+    qint64 lastTimestamp() const { return timestampAt(m_size - 1); }
+
+    // Logical index of the first sample at or after timestampMs (size() if none)
+    int lowerBound(qint64 timestampMs) const;
+
+    // Bulk export of one column as (timestamp ms, value) points, oldest first,
+    // starting at logical index first. The list is reused by the caller so
+    // steady-state refreshes don't allocate.
+    void toPoints(int column, QList<QPointF>& points, int first = 0) const;
+
+private:
+    int physicalIndex(int index) const
+    {
+        int physical = m_head + index;
+        return physical >= m_capacity ? physical - m_capacity : physical;
+    }
+
+    int m_capacity;
+    int m_head = 0;   // physical slot of the oldest sample
+    int m_size = 0;
+    QVector<qint64> m_timestamps;
+    QVector<float> m_columns[ColumnCount];
+};
+
+#endif // SAMPLERINGBUFFER_H
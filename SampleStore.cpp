@@ -0,0 +1,456 @@
+// SampleStore.cpp
+#include "SampleStore.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimeZone>
+#include <QUrl>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+static const char COVERAGE_FILE[] = "coverage.dat";
+
+QString SampleStore::defaultRoot()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/samples";
+}
+
+SampleStore::SampleStore(const QString& root)
+    : m_root(root)
+{
+}
+
+SampleStore::~SampleStore()
+{
+    flush();
+    qDeleteAll(m_writers);
+}
+
+QString SampleStore::topicDirectory(const QString& topic) const
+{
+    // Topics contain '/', which must not create nested directories
+    return m_root + "/" + QString::fromLatin1(QUrl::toPercentEncoding(topic));
+}
+
+QString SampleStore::segmentName(qint64 segmentStartMs)
+{
+    return QDateTime::fromMSecsSinceEpoch(segmentStartMs, QTimeZone::UTC).toString("yyyyMMdd-HH") + ".seg";
+}
+
+qint64 SampleStore::segmentStart(const QString& fileName)
+{
+    // Parsed field by field straight into UTC; parsing as local time first
+    // would lose or shift the hours around a DST change
+    const QDate date = QDate::fromString(fileName.left(8), "yyyyMMdd");
+    bool hourValid = false;
+    const int hour = fileName.mid(9, 2).toInt(&hourValid);
+    if (!date.isValid() || fileName.size() < 11 || fileName[8] != '-' || !hourValid || hour < 0 || hour > 23)
+        return -1;
+    return QDateTime(date, QTime(hour, 0), QTimeZone::UTC).toMSecsSinceEpoch();
+}
+
+QByteArray SampleStore::header()
+{
+    QByteArray bytes(HEADER_SIZE, '\0');
+    char* data = bytes.data();
+    std::memcpy(data, "PSEG", 4);
+    qToLittleEndian<quint16>(FORMAT_VERSION, data + 4);
+    qToLittleEndian<quint16>(ChannelSchema::ChannelCount, data + 6);
+    qToLittleEndian<quint32>(RECORD_SIZE, data + 8);
+    return bytes;
+}
+
+QByteArray SampleStore::coverageHeader()
+{
+    QByteArray bytes(COVERAGE_HEADER_SIZE, '\0');
+    char* data = bytes.data();
+    std::memcpy(data, "PCOV", 4);
+    qToLittleEndian<quint16>(FORMAT_VERSION, data + 4);
+    return bytes;
+}
+
+QVector<SampleStore::Span> SampleStore::readSpans(const QString& directory)
+{
+    QVector<Span> spans;
+    QFile file(directory + "/" + COVERAGE_FILE);
+    if (!file.open(QIODevice::ReadOnly))
+        return spans;
+
+    // A record being appended right now is not complete yet and is skipped
+    const QByteArray bytes = file.readAll();
+    if (bytes.size() < COVERAGE_HEADER_SIZE || std::memcmp(bytes.constData(), "PCOV", 4) != 0)
+        return spans;
+
+    const int records = (bytes.size() - COVERAGE_HEADER_SIZE) / COVERAGE_RECORD_SIZE;
+    spans.reserve(records);
+    for (int index = 0; index < records; ++index) {
+        const char* record = bytes.constData() + COVERAGE_HEADER_SIZE + index * COVERAGE_RECORD_SIZE;
+        const qint64 firstMs = qFromLittleEndian<qint64>(record);
+        const qint64 lastMs = qFromLittleEndian<qint64>(record + sizeof(qint64));
+        if (firstMs <= lastMs) {
+            spans.append({firstMs, lastMs + 1});
+        }
+    }
+    return spans;
+}
+
+qint64 SampleStore::lastTimestamp(const QString& directory) const
+{
+    // Last record of the newest segment that has one
+    const QDir dir(directory);
+    const QStringList segments = dir.entryList(QStringList("*.seg"), QDir::Files, QDir::Name | QDir::Reversed);
+
+    for (const QString& name : segments) {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::ReadOnly) || file.size() < HEADER_SIZE + RECORD_SIZE)
+            continue;
+
+        const qint64 records = (file.size() - HEADER_SIZE) / RECORD_SIZE;
+        char timestamp[sizeof(qint64)];
+        if (file.seek(HEADER_SIZE + (records - 1) * RECORD_SIZE)
+            && file.read(timestamp, sizeof(timestamp)) == sizeof(timestamp))
+            return qFromLittleEndian<qint64>(timestamp);
+    }
+    return std::numeric_limits<qint64>::min();
+}
+
+bool SampleStore::openSegment(Writer& writer, qint64 segmentStartMs)
+{
+    flush(writer);
+    writer.file.close();
+    writer.segmentStartMs = -1;
+
+    if (!QDir().mkpath(writer.directory)) {
+        qWarning() << "Cannot create sample store directory" << writer.directory;
+        return false;
+    }
+
+    writer.file.setFileName(writer.directory + "/" + segmentName(segmentStartMs));
+    if (!writer.file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Cannot open sample segment" << writer.file.fileName() << writer.file.errorString();
+        return false;
+    }
+
+    // A new segment starts with its header; an existing one is appended to,
+    // after dropping any record torn by a crash
+    const qint64 size = writer.file.size();
+    if (size < HEADER_SIZE) {
+        writer.file.resize(0);
+        writer.file.write(header());
+    } else if ((size - HEADER_SIZE) % RECORD_SIZE != 0) {
+        writer.file.resize(size - (size - HEADER_SIZE) % RECORD_SIZE);
+    }
+
+    writer.segmentStartMs = segmentStartMs;
+    return true;
+}
+
+void SampleStore::append(const QString& topic, const PowerSample& sample)
+{
+    Writer*& writer = m_writers[topic];
+    if (!writer) {
+        writer = new Writer;
+        writer->directory = topicDirectory(topic);
+        writer->lastMs = lastTimestamp(writer->directory);
+    }
+
+    // Segments are binary searched, so records have to stay in time order;
+    // after a clock step or a reordered frame the older samples are dropped
+    if (sample.timestampMs < writer->lastMs) {
+        if ((m_droppedSamples++ % 1000) == 0) {
+            qWarning() << "Sample store dropped" << m_droppedSamples << "out-of-order samples";
+        }
+        return;
+    }
+
+    // A sample that can't be stored ends the span: it must not claim it
+    const qint64 segmentStartMs = sample.timestampMs - sample.timestampMs % SEGMENT_SPAN_MS;
+    if (segmentStartMs != writer->segmentStartMs && !openSegment(*writer, segmentStartMs)) {
+        endSpan(*writer);
+        return;
+    }
+
+    char record[RECORD_SIZE];
+    qToLittleEndian<qint64>(sample.timestampMs, record);
+    for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+        quint32 bits;
+        std::memcpy(&bits, &sample.values[channel], sizeof(float));
+        qToLittleEndian<quint32>(bits, record + sizeof(qint64) + channel * sizeof(float));
+    }
+    writer->buffer.append(record, RECORD_SIZE);
+    writer->lastMs = sample.timestampMs;
+    if (writer->spanFromMs < 0) {
+        writer->spanFromMs = sample.timestampMs;
+    }
+
+    if (writer->buffer.size() >= FLUSH_THRESHOLD) {
+        flush(*writer);
+    }
+}
+
+void SampleStore::flush()
+{
+    for (Writer* writer : std::as_const(m_writers)) {
+        flush(*writer);
+    }
+}
+
+void SampleStore::flush(Writer& writer)
+{
+    if (writer.buffer.isEmpty() || !writer.file.isOpen())
+        return;
+
+    writer.file.write(writer.buffer);
+    writer.file.flush();
+    writer.buffer.clear();
+
+    // Only now that they are on disk may the span claim these samples
+    writeSpan(writer);
+}
+
+void SampleStore::writeSpan(Writer& writer)
+{
+    if (writer.spanFromMs < 0)
+        return;
+
+    if (!writer.coverage.isOpen()) {
+        writer.coverage.setFileName(writer.directory + "/" + COVERAGE_FILE);
+        if (!writer.coverage.open(QIODevice::ReadWrite)) {
+            qWarning() << "Cannot open sample coverage" << writer.coverage.fileName() << writer.coverage.errorString();
+            return;
+        }
+
+        // Same repair as for segments
+        const qint64 size = writer.coverage.size();
+        if (size < COVERAGE_HEADER_SIZE) {
+            writer.coverage.resize(0);
+            writer.coverage.write(coverageHeader());
+        } else if ((size - COVERAGE_HEADER_SIZE) % COVERAGE_RECORD_SIZE != 0) {
+            writer.coverage.resize(size - (size - COVERAGE_HEADER_SIZE) % COVERAGE_RECORD_SIZE);
+        }
+    }
+
+    // The open span's record is appended once and then rewritten in place
+    if (writer.spanOffset < 0) {
+        writer.spanOffset = writer.coverage.size();
+    }
+
+    char record[COVERAGE_RECORD_SIZE];
+    qToLittleEndian<qint64>(writer.spanFromMs, record);
+    qToLittleEndian<qint64>(writer.lastMs, record + sizeof(qint64));
+    if (writer.coverage.seek(writer.spanOffset)) {
+        writer.coverage.write(record, COVERAGE_RECORD_SIZE);
+        writer.coverage.flush();
+    }
+}
+
+void SampleStore::endSpan(const QString& topic)
+{
+    Writer* writer = m_writers.value(topic);
+    if (writer) {
+        endSpan(*writer);
+    }
+}
+
+void SampleStore::endSpans()
+{
+    for (Writer* writer : std::as_const(m_writers)) {
+        endSpan(*writer);
+    }
+}
+
+void SampleStore::endSpan(Writer& writer)
+{
+    flush(writer);
+    writer.spanFromMs = -1;
+    writer.spanOffset = -1;
+}
+
+void SampleStore::sweep()
+{
+    // Only whole segments are deleted, so what is kept starts at a segment
+    // boundary
+    const qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - m_retentionMs;
+    const qint64 keptFromMs = cutoff - cutoff % SEGMENT_SPAN_MS;
+
+    const QDir root(m_root);
+    const QStringList topics = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString& name : topics) {
+        sweep(root.filePath(name), keptFromMs);
+    }
+}
+
+void SampleStore::sweep(const QString& directory, qint64 keptFromMs)
+{
+    Writer* writer = nullptr;
+    for (Writer* candidate : std::as_const(m_writers)) {
+        if (candidate->directory == directory) {
+            writer = candidate;
+        }
+    }
+
+    // Readers may still have a segment mapped; where that blocks the
+    // delete, the next sweep gets it
+    QDir dir(directory);
+    const QStringList segments = dir.entryList(QStringList("*.seg"), QDir::Files, QDir::Name);
+    int kept = 0;
+    for (const QString& name : segments) {
+        const qint64 startMs = segmentStart(name);
+        if (startMs < 0 || startMs >= keptFromMs || (writer && startMs == writer->segmentStartMs) || !dir.remove(name)) {
+            ++kept;
+        }
+    }
+
+    // Spans are clipped to what is left. The writer's open span is left out
+    // and appended again by its next flush.
+    if (writer) {
+        flush(*writer);
+        writer->coverage.close();
+        if (writer->spanFromMs >= 0) {
+            writer->spanFromMs = qMax(writer->spanFromMs, keptFromMs);
+        }
+    }
+
+    const QVector<Span> spans = readSpans(directory);
+    const int openRecord = writer && writer->spanOffset >= 0
+                               ? int((writer->spanOffset - COVERAGE_HEADER_SIZE) / COVERAGE_RECORD_SIZE)
+                               : -1;
+    if (writer) {
+        writer->spanOffset = -1;
+    }
+
+    QByteArray bytes = coverageHeader();
+    for (int index = 0; index < spans.size(); ++index) {
+        if (index == openRecord || spans[index].toMs <= keptFromMs)
+            continue;
+
+        char record[COVERAGE_RECORD_SIZE];
+        qToLittleEndian<qint64>(qMax(spans[index].fromMs, keptFromMs), record);
+        qToLittleEndian<qint64>(spans[index].toMs - 1, record + sizeof(qint64));
+        bytes.append(record, COVERAGE_RECORD_SIZE);
+    }
+
+    // A topic that is gone entirely leaves nothing behind
+    if (kept == 0 && bytes.size() == COVERAGE_HEADER_SIZE && !writer) {
+        dir.removeRecursively();
+        return;
+    }
+
+    // Replaced in one step, so readers see either version whole
+    QSaveFile file(dir.filePath(COVERAGE_FILE));
+    if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size() || !file.commit()) {
+        qWarning() << "Cannot rewrite sample coverage" << file.fileName() << file.errorString();
+    }
+
+    if (writer) {
+        writeSpan(*writer);
+    }
+}
+
+QVector<SampleStore::Span> SampleStore::coverage(const QString& topic, qint64 fromMs, qint64 toMs) const
+{
+    QVector<Span> spans = readSpans(topicDirectory(topic));
+    std::sort(spans.begin(), spans.end(), [](const Span& a, const Span& b) { return a.fromMs < b.fromMs; });
+
+    // Clipped to the range, with touching spans merged
+    QVector<Span> covered;
+    for (const Span& span : std::as_const(spans)) {
+        const qint64 spanFrom = qMax(span.fromMs, fromMs);
+        const qint64 spanTo = qMin(span.toMs, toMs);
+        if (spanFrom >= spanTo)
+            continue;
+
+        if (!covered.isEmpty() && spanFrom <= covered.last().toMs) {
+            covered.last().toMs = qMax(covered.last().toMs, spanTo);
+        } else {
+            covered.append({spanFrom, spanTo});
+        }
+    }
+    return covered;
+}
+
+bool SampleStore::covers(const QString& topic, qint64 fromMs, qint64 toMs) const
+{
+    const QVector<Span> covered = coverage(topic, fromMs, toMs);
+    return covered.size() == 1 && covered.first().fromMs == fromMs && covered.first().toMs == toMs;
+}
+
+void SampleStore::query(const QString& topic, qint64 fromMs, qint64 toMs, const Visitor& visitor) const
+{
+    // Segment names sort chronologically
+    const QDir directory(topicDirectory(topic));
+    const QStringList segments = directory.entryList(QStringList("*.seg"), QDir::Files, QDir::Name);
+
+    for (const QString& name : segments) {
+        const qint64 startMs = segmentStart(name);
+        if (startMs < 0 || startMs > toMs || startMs + SEGMENT_SPAN_MS <= fromMs)
+            continue;
+
+        QFile file(directory.filePath(name));
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        // Only whole records; the writer may be appending right now
+        const qint64 size = file.size();
+        if (size < HEADER_SIZE)
+            continue;
+        const qint64 records = (size - HEADER_SIZE) / RECORD_SIZE;
+
+        const uchar* data = file.map(0, HEADER_SIZE + records * RECORD_SIZE);
+        if (!data)
+            continue;
+
+        const char* bytes = reinterpret_cast<const char*>(data);
+        if (std::memcmp(bytes, "PSEG", 4) != 0
+            || qFromLittleEndian<quint16>(bytes + 6) != ChannelSchema::ChannelCount
+            || qFromLittleEndian<quint32>(bytes + 8) != quint32(RECORD_SIZE)) {
+            qWarning() << "Skipping incompatible sample segment" << file.fileName();
+            file.unmap(const_cast<uchar*>(data));
+            continue;
+        }
+
+        const char* base = bytes + HEADER_SIZE;
+        auto timestampAt = [base](qint64 index) {
+            return qFromLittleEndian<qint64>(base + index * RECORD_SIZE);
+        };
+
+        // Records are appended in time order: binary search the first one
+        qint64 low = 0;
+        qint64 high = records;
+        while (low < high) {
+            const qint64 middle = (low + high) / 2;
+            if (timestampAt(middle) < fromMs)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        PowerSample sample;
+        for (qint64 index = low; index < records; ++index) {
+            const char* record = base + index * RECORD_SIZE;
+            sample.timestampMs = qFromLittleEndian<qint64>(record);
+            if (sample.timestampMs > toMs)
+                break;
+
+            for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+                const quint32 bits = qFromLittleEndian<quint32>(record + sizeof(qint64) + channel * sizeof(float));
+                std::memcpy(&sample.values[channel], &bits, sizeof(float));
+            }
+            visitor(sample);
+        }
+
+        file.unmap(const_cast<uchar*>(data));
+    }
+}
+
+QVector<PowerSample> SampleStore::read(const QString& topic, qint64 fromMs, qint64 toMs) const
+{
+    QVector<PowerSample> samples;
+    query(topic, fromMs, toMs, [&samples](const PowerSample& sample) {
+        samples.append(sample);
+    });
+    return samples;
+}
@@ -0,0 +1,125 @@
+// SampleStore.h
+#ifndef SAMPLESTORE_H
+#define SAMPLESTORE_H
+
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <QByteArray>
+#include <QVector>
+#include <functional>
+#include <limits>
+#include "PowerSample.h"
+
+// Local append-only store of every decoded sample, so history survives a
+// restart and lookups don't need the backend.
+//
+// On-disk layout, one directory per topic and one segment file per UTC hour:
+//   <root>/<percent-encoded topic>/<yyyyMMdd-HH>.seg
+// A segment is a 16-byte header followed by fixed-size little-endian records
+//   header  "PSEG", quint16 version, quint16 channel count, quint32 record size,
+//           quint32 reserved
+//   record  qint64 timestamp ms, then one float32 per ChannelSchema channel
+//
+// The store only holds what this client received while it was running and
+// connected. <topic>/coverage.dat lists those spans, one per ingest session:
+//   header  "PCOV", quint16 version, quint16 reserved
+//   record  qint64 first and qint64 last timestamp ms of the span
+// A span is closed by endSpan() when samples may have been missed (the
+// connection dropped, the topic was unsubscribed); the next sample starts a
+// new one. Anything between spans has to come from the backend.
+//
+// One instance (the ingest thread's) appends; writes are buffered and flushed
+// by flush() or once a buffer fills, and a span only ever claims flushed
+// records. The same instance deletes segments older than the retention in
+// sweep(). Any number of other instances can read at the same time: segments
+// are mapped with QFile::map() and binary searched, so a query costs no copies
+// beyond the samples it returns.
+class SampleStore
+{
+public:
+    using Visitor = std::function<void(const PowerSample&)>;
+
+    // Half-open span of time, [fromMs, toMs)
+    struct Span {
+        qint64 fromMs;
+        qint64 toMs;
+    };
+
+    static constexpr qint64 DEFAULT_RETENTION_MS = qint64(30) * 24 * 60 * 60 * 1000;
+
+    static QString defaultRoot();
+
+    explicit SampleStore(const QString& root = defaultRoot());
+    ~SampleStore();
+
+    SampleStore(const SampleStore&) = delete;
+    SampleStore& operator=(const SampleStore&) = delete;
+
+    // Samples must arrive in time order per topic; older ones are dropped
+    void append(const QString& topic, const PowerSample& sample);
+    void flush();
+    // Closes the topic's coverage span (every topic's, without a topic)
+    void endSpan(const QString& topic);
+    void endSpans();
+
+    // Segments wholly older than the retention are deleted by sweep()
+    void setRetention(qint64 retentionMs) { m_retentionMs = qMax(qint64(SEGMENT_SPAN_MS), retentionMs); }
+    qint64 retention() const { return m_retentionMs; }
+    void sweep();
+
+    // Parts of [fromMs, toMs) the store holds every received sample of,
+    // oldest first
+    QVector<Span> coverage(const QString& topic, qint64 fromMs, qint64 toMs) const;
+    bool covers(const QString& topic, qint64 fromMs, qint64 toMs) const;
+
+    // Visits every stored sample of a topic with a timestamp in [fromMs, toMs],
+    // oldest first. Samples carry topicId -1.
+    void query(const QString& topic, qint64 fromMs, qint64 toMs, const Visitor& visitor) const;
+    QVector<PowerSample> read(const QString& topic, qint64 fromMs, qint64 toMs) const;
+
+private:
+    static const int HEADER_SIZE = 16;
+    static const int RECORD_SIZE = sizeof(qint64) + ChannelSchema::ChannelCount * sizeof(float);
+    static const quint16 FORMAT_VERSION = 1;
+    static const qint64 SEGMENT_SPAN_MS = 60 * 60 * 1000;
+    static const int FLUSH_THRESHOLD = 64 * 1024;
+    static const int COVERAGE_HEADER_SIZE = 8;
+    static const int COVERAGE_RECORD_SIZE = 2 * sizeof(qint64);
+
+    struct Writer {
+        QString directory;
+        QFile file;
+        qint64 segmentStartMs = -1;
+        QByteArray buffer;
+        // Newest appended timestamp; older samples are dropped
+        qint64 lastMs = std::numeric_limits<qint64>::min();
+
+        // Open coverage span, -1 if none, and the offset of its record in
+        // the coverage file, -1 until it was first written
+        QFile coverage;
+        qint64 spanFromMs = -1;
+        qint64 spanOffset = -1;
+    };
+
+    QString topicDirectory(const QString& topic) const;
+    static QString segmentName(qint64 segmentStartMs);
+    static qint64 segmentStart(const QString& fileName);
+    static QByteArray header();
+    static QByteArray coverageHeader();
+    // Every span recorded in a topic directory, in file order
+    static QVector<Span> readSpans(const QString& directory);
+    qint64 lastTimestamp(const QString& directory) const;
+    bool openSegment(Writer& writer, qint64 segmentStartMs);
+    void flush(Writer& writer);
+    void writeSpan(Writer& writer);
+    void endSpan(Writer& writer);
+    void sweep(const QString& directory, qint64 keptFromMs);
+
+    QString m_root;
+    QHash<QString, Writer*> m_writers;
+    qint64 m_retentionMs = DEFAULT_RETENTION_MS;
+    int m_droppedSamples = 0;
+};
+
+#endif // SAMPLESTORE_H
@@ -1,28 +1,25 @@
 #include "ScheduleManagerDialog.h"
 #include "LocationDetailDialog.h"
+#include "ApiClient.h"
 #include <QFont>
 #include <QMessageBox>
-#include <QtWebSockets/QWebSocket>
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QJsonArray>
-#include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QUrl>
 
 
-ScheduleManagerDialog::ScheduleManagerDialog(QWidget* parent, int locationIndex, const QString& locationName, QColor locationColor,QString& topic,QWebSocket* socket)
+ScheduleManagerDialog::ScheduleManagerDialog(QWidget* parent, int locationIndex, const QString& locationName, QColor locationColor,QString& topic)
     : QDialog(parent),
     m_locationIndex(locationIndex),
     m_locationName(locationName),
     m_locationColor(locationColor),
-    m_topic(topic),
-    m_socket(socket)
+    m_topic(topic)
 
 
 {
-    manager = new QNetworkAccessManager(this);  //setup network MAnager
     setWindowTitle(QString("Schedule Manager - %1").arg(locationName));
     setMinimumSize(800, 600);
     setupUI();
@@ -86,19 +83,15 @@ void ScheduleManagerDialog::loadSchedules()
 
 
     //setup Request
-    QNetworkRequest request(QUrl("http://localhost:8080/scheduler"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,"application/json");
+    QNetworkRequest request = ApiClient::instance()->request("/scheduler");
 
     //send GETRequest
-    QNetworkReply* reply = manager->get(request,jsonData);
-
-    QObject::connect(reply,&QNetworkReply::finished,this,[this,reply](){
-        if(reply->error() == QNetworkReply::NoError){
+    ApiClient::instance()->fetch(request,"GET",jsonData,this,[this](const ApiClient::Response& response){
+        if(response.error == QNetworkReply::NoError){
 
             scheduleListWidget->clear();
 
-            QByteArray response = reply->readAll();
-            QJsonDocument doc = QJsonDocument::fromJson(response);
+            QJsonDocument doc = QJsonDocument::fromJson(response.body);
 
             QJsonArray data = doc.array();
 
@@ -123,9 +116,8 @@ void ScheduleManagerDialog::loadSchedules()
 
 
         }else{
-            qDebug() << "Error" << reply->errorString();
+            qDebug() << "Error" << response.errorString;
         }
-        reply->deleteLater();
     });
 
 }
@@ -284,20 +276,15 @@ void ScheduleManagerDialog::saveScheduleToDB(QTime startTime,QTime endTime){
 
 
     //setup Request
-    QNetworkRequest request(QUrl("http://localhost:8080/scheduler"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,"application/json");
+    QNetworkRequest request = ApiClient::instance()->request("/scheduler");
 
     //send PostRequest
-    QNetworkReply* reply = manager->post(request,jsonData);
-
-    QObject::connect(reply,&QNetworkReply::finished,this,[reply](){
-        if(reply->error() == QNetworkReply::NoError){
-            QByteArray response = reply->readAll();
-            qDebug() << "Response from BAckend: " << response;
+    ApiClient::instance()->fetch(request,"POST",jsonData,this,[](const ApiClient::Response& response){
+        if(response.error == QNetworkReply::NoError){
+            qDebug() << "Response from BAckend: " << response.body;
         }else{
-            qDebug() << "Error" << reply->errorString();
+            qDebug() << "Error" << response.errorString;
         }
-        reply->deleteLater();
     });
 
 
@@ -318,20 +305,15 @@ void ScheduleManagerDialog::deleteScheduleFromDB(QTime startTime,QTime endTime){
 
 
     //setup Request
-    QNetworkRequest request(QUrl("http://localhost:8080/scheduler"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,"application/json");
-
-    //send PostRequest
-    QNetworkReply* reply = manager->sendCustomRequest(request,"DELETE",jsonData);
+    QNetworkRequest request = ApiClient::instance()->request("/scheduler");
 
-    QObject::connect(reply,&QNetworkReply::finished,[reply](){
-        if(reply->error() == QNetworkReply::NoError){
-            QByteArray response = reply->readAll();
-            qDebug() << "Response from BAckend: " << response;
+    //send DeleteRequest
+    ApiClient::instance()->fetch(request,"DELETE",jsonData,this,[](const ApiClient::Response& response){
+        if(response.error == QNetworkReply::NoError){
+            qDebug() << "Response from BAckend: " << response.body;
         }else{
-            qDebug() << "Error" << reply->errorString();
+            qDebug() << "Error" << response.errorString;
         }
-        reply->deleteLater();
     });
 }
 
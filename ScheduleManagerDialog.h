@@ -12,16 +12,14 @@
 #include <QColor>
 #include <QVector>
 #include <QTime>
-#include <QtWebSockets/QWebSocket>
 #include <QString>
-#include <QNetworkAccessManager>
 
 class ScheduleManagerDialog : public QDialog
 {
     Q_OBJECT
 
 public:
-    ScheduleManagerDialog(QWidget* parent, int locationIndex, const QString& locationName, QColor locationColor,QString& topic,QWebSocket* socket );
+    ScheduleManagerDialog(QWidget* parent, int locationIndex, const QString& locationName, QColor locationColor,QString& topic);
 
     struct Schedule {
         QTime startTime;
@@ -52,9 +50,7 @@ private:
     QVBoxLayout* mainLayout;
     QListWidget* scheduleListWidget;
     QString m_topic;
-    QWebSocket* m_socket;
     QVector<Schedule> schedules;
-    QNetworkAccessManager* manager;
 
 };
 
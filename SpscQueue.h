@@ -0,0 +1,76 @@
+// SpscQueue.h
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free single-producer/single-consumer ring buffer.
+// The producer and the consumer may live on different threads; neither side
+// ever blocks or allocates after construction.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_buffer(roundUpToPowerOfTwo(capacity)),
+        m_mask(m_buffer.size() - 1)
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return m_buffer.size(); }
+
+    // Producer side. Returns false (and drops the item) when the queue is full.
+    bool push(const T& item)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        const size_t tail = m_tail.load(std::memory_order_acquire);
+        if (head - tail == m_buffer.size())
+            return false;
+
+        m_buffer[head & m_mask] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Calls fn(const T&) for every queued item in order, reading
+    // the items in place, and then releases the slots back to the producer.
+    template <typename Fn>
+    size_t drain(Fn&& fn)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i)
+            fn(static_cast<const T&>(m_buffer[i & m_mask]));
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+private:
+    static size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t result = 2;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    std::vector<T> m_buffer;
+    const size_t m_mask;
+
+    // Keep the indices on separate cache lines so the two threads don't
+    // invalidate each other on every push/drain.
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+#endif // SPSCQUEUE_H
@@ -1,4 +1,7 @@
 #include "datarecorddialog.h"
+#include "ApiClient.h"
+#include "CsvExporter.h"
+#include "RecordArchive.h"
 #include <QFont>
 #include <QMessageBox>
 #include <QHeaderView>
@@ -6,31 +9,44 @@
 #include <QDateTime>
 #include <QNetworkRequest>
 #include <QUrl>
-#include <QPdfWriter>
+#include <QPicture>
 #include <QTextDocument>
 #include <QDesktopServices>
 #include <QFile>
 #include <QTextStream>
-#include <QWebSocket>
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <QtConcurrent/QtConcurrentRun>
 
 DataRecordDialog::DataRecordDialog(QWidget* parent, int locationIndex, const QString& locationName,
-                                   QColor locationColor, QString& topic, QWebSocket* socket)
+                                   QColor locationColor, QString& topic)
     : QDialog(parent),
     m_locationIndex(locationIndex),
     m_locationName(locationName),
     m_locationColor(locationColor),
-    m_topic(topic),
-    m_socket(socket)
+    m_topic(topic)
 {
     setWindowTitle(QString("Data Recording - %1").arg(locationName));
     setMinimumSize(1000, 600);
-    networkManager = new QNetworkAccessManager(this);
+    m_decodePool.setMaxThreadCount(1);
+    m_reportPool.setMaxThreadCount(1);
     setupUI();
 }
 
 DataRecordDialog::~DataRecordDialog()
 {
-    // Clean up resources if needed
+    // The report pool waits for its job when destroyed; make that short
+    m_reportFuture.cancel();
+
+    // Aborting emits finished(); nothing of the dialog may be touched by then
+    if (m_fetchReply) {
+        disconnect(m_fetchReply, nullptr, this, nullptr);
+        m_fetchReply->abort();
+        m_fetchReply->deleteLater();
+    }
 }
 
 void DataRecordDialog::setupUI()
@@ -62,29 +78,55 @@ void DataRecordDialog::setupUI()
     fetchButton = new QPushButton("Fetch Data");
     connect(fetchButton, &QPushButton::clicked, this, &DataRecordDialog::fetchData);
 
+    cancelButton = new QPushButton("Cancel");
+    connect(cancelButton, &QPushButton::clicked, this, &DataRecordDialog::cancelFetch);
+    cancelButton->hide(); // Only while a fetch is running
+
     dateTimeLayout->addWidget(startLabel);
     dateTimeLayout->addWidget(startDateTimeEdit);
     dateTimeLayout->addWidget(endLabel);
     dateTimeLayout->addWidget(endDateTimeEdit);
     dateTimeLayout->addWidget(fetchButton);
+    dateTimeLayout->addWidget(cancelButton);
 
     mainLayout->addLayout(dateTimeLayout);
 
-    // Table for data display
-    dataTable = new QTableWidget(this);
-    dataTable->setColumnCount(13); // Updated column count for all values
-    dataTable->setHorizontalHeaderLabels(QStringList() 
-        << "Timestamp" 
-        << "Total Power" 
-        << "P1" << "P2" << "P3"
-        << "Total Current" 
-        << "C1" << "C2" << "C3"
-        << "Total Voltage" 
-        << "V1" << "V2" << "V3");
-    dataTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // Fetch progress, measured by how far into the requested period the rows reach
+    QHBoxLayout* statusLayout = new QHBoxLayout();
+    statusLabel = new QLabel();
+    fetchProgress = new QProgressBar();
+    fetchProgress->setRange(0, PROGRESS_STEPS);
+    fetchProgress->setTextVisible(false);
+    fetchProgress->hide();
+    statusLayout->addWidget(statusLabel);
+    statusLayout->addWidget(fetchProgress, 1);
+    mainLayout->addLayout(statusLayout);
+
+    // Table for data display; the model keeps the records in columns and
+    // only formats the cells on screen
+    recordModel = new RecordTableModel(this);
+
+    dataTable = new QTableView(this);
+    dataTable->setModel(recordModel);
+    // Sized once per fetch; ResizeToContents would measure every row on every insert
+    dataTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    // Fixed row heights: scrolling through millions of rows measures nothing
+    dataTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    dataTable->setWordWrap(false);
     dataTable->setEditTriggers(QAbstractItemView::NoEditTriggers); // Read-only
     dataTable->setAlternatingRowColors(true);
-    mainLayout->addWidget(dataTable);
+
+    // The trend is drawn from aggregated buckets; raw rows are only loaded
+    // once the records tab is opened
+    historyChart = new HistoryChart(m_clusterId, m_topic, m_locationColor);
+    historyChart->setWindow(startDateTimeEdit->dateTime().toMSecsSinceEpoch(),
+                            endDateTimeEdit->dateTime().toMSecsSinceEpoch());
+
+    viewTabs = new QTabWidget();
+    viewTabs->addTab(historyChart, "Chart");
+    viewTabs->addTab(dataTable, "Records");
+    connect(viewTabs, &QTabWidget::currentChanged, this, &DataRecordDialog::onViewChanged);
+    mainLayout->addWidget(viewTabs, 1);
 
     // Export buttons
     QHBoxLayout* exportLayout = new QHBoxLayout();
@@ -100,8 +142,17 @@ void DataRecordDialog::setupUI()
     QPushButton* closeButton = new QPushButton("Close");
     connect(closeButton, &QPushButton::clicked, this, &QDialog::accept);
 
+    exportArchiveButton = new QPushButton("Export as Archive");
+    connect(exportArchiveButton, &QPushButton::clicked, this, &DataRecordDialog::exportArchive);
+    exportArchiveButton->setEnabled(false); // Enable only after data is fetched
+
+    QPushButton* openArchiveButton = new QPushButton("Open Archive...");
+    connect(openArchiveButton, &QPushButton::clicked, this, &DataRecordDialog::openArchive);
+
     exportLayout->addWidget(exportPDFButton);
     exportLayout->addWidget(exportCSVButton);
+    exportLayout->addWidget(exportArchiveButton);
+    exportLayout->addWidget(openArchiveButton);
     exportLayout->addStretch();
     exportLayout->addWidget(closeButton);
 
@@ -110,13 +161,98 @@ void DataRecordDialog::setupUI()
 
 void DataRecordDialog::fetchData()
 {
+    historyChart->setWindow(startDateTimeEdit->dateTime().toMSecsSinceEpoch(),
+                            endDateTimeEdit->dateTime().toMSecsSinceEpoch());
+
+    m_recordsStale = true;
+    m_showingArchive = false;
+    if (viewTabs->currentWidget() == dataTable) {
+        fetchRecords();
+    }
+}
+
+void DataRecordDialog::onViewChanged()
+{
+    if (m_recordsStale && viewTabs->currentWidget() == dataTable) {
+        fetchRecords();
+    }
+}
+
+void DataRecordDialog::fetchRecords()
+{
+    if (m_fetchReply || m_pendingDecodes > 0)
+        return;
+    m_recordsStale = false;
+
+    const qint64 fromMs = startDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    const qint64 toMs = endDateTimeEdit->dateTime().toMSecsSinceEpoch();
+
+    startFetch(fromMs, toMs, "Reading cached history...");
+    // Ranges are half-open from here on; the selected end is included
+    m_fetchCoverage = SampleStore().coverage(m_topic, fromMs, toMs + 1);
+    m_fetchPlan = RecordCache::instance()->lookup(m_topic, fromMs, toMs + 1);
+    continueFetch();
+}
+
+void DataRecordDialog::continueFetch()
+{
+    // Pieces already at hand are queued right away; the decode pool keeps
+    // them in order with whatever the backend sends after
+    while (!m_fetchPlan.isEmpty()) {
+        RecordCache::Piece piece = m_fetchPlan.takeFirst();
+        if (piece.cached) {
+            const RecordColumns records = piece.records;
+            submitDecode([records]() { return records; });
+            continue;
+        }
+
+        // The local store has whatever arrived while this client was
+        // connected; only the time in between needs the backend
+        while (!m_fetchCoverage.isEmpty() && m_fetchCoverage.first().toMs <= piece.fromMs) {
+            m_fetchCoverage.removeFirst();
+        }
+        if (!m_fetchCoverage.isEmpty() && m_fetchCoverage.first().fromMs <= piece.fromMs) {
+            const qint64 storedToMs = qMin(piece.toMs, m_fetchCoverage.first().toMs);
+            if (storedToMs < piece.toMs) {
+                m_fetchPlan.prepend({storedToMs, piece.toMs, false, {}});
+            }
+
+            const QString topic = m_topic;
+            const qint64 fromMs = piece.fromMs;
+            const qint64 lastMs = storedToMs - 1;
+            submitDecode([topic, fromMs, lastMs]() { return RecordColumns::fromStore(topic, fromMs, lastMs); });
+            continue;
+        }
+        if (!m_fetchCoverage.isEmpty() && m_fetchCoverage.first().fromMs < piece.toMs) {
+            m_fetchPlan.prepend({m_fetchCoverage.first().fromMs, piece.toMs, false, {}});
+            piece.toMs = m_fetchCoverage.first().fromMs;
+        }
+
+        requestRange(piece.fromMs, piece.toMs);
+        return;
+    }
+
+    m_fetchInputDone = true;
+    if (m_pendingDecodes == 0) {
+        completeFetch();
+    }
+}
+
+void DataRecordDialog::requestRange(qint64 fromMs, qint64 toMs)
+{
+    m_requestFromMs = fromMs;
+    m_requestToMs = toMs;
+    m_fetchFormat = UnknownFormat;
+    m_fetchParser.reset();
+    m_fetchBody.clear();
+
     // Prepare JSON request
-    qDebug() << "FEtch data called";
     QJsonObject requestObj;
-    requestObj["cluster_id"] = "1";   // HAVE TO WORK OUT
+    requestObj["cluster_id"] = m_clusterId;
     requestObj["topic_name"] = m_topic;
-    requestObj["start_time"] = startDateTimeEdit->dateTime().toString(Qt::ISODate);
-    requestObj["end_time"] = endDateTimeEdit->dateTime().toString(Qt::ISODate);
+    // Pieces start and end at any millisecond, so the bounds keep them
+    requestObj["start_time"] = QDateTime::fromMSecsSinceEpoch(fromMs).toString(Qt::ISODateWithMs);
+    requestObj["end_time"] = QDateTime::fromMSecsSinceEpoch(toMs).toString(Qt::ISODateWithMs);
 
     QJsonDocument requestDoc(requestObj);
     QByteArray jsonData = requestDoc.toJson(QJsonDocument::Compact);
@@ -124,261 +260,351 @@ void DataRecordDialog::fetchData()
     //  FOR HTTP REQUEST
 
     //setup Request
-    QNetworkRequest request(QUrl("http://localhost:8080/recordData"));
-    request.setHeader(QNetworkRequest::ContentTypeHeader,"application/json");
+    QNetworkRequest request = ApiClient::instance()->request("/recordData");
+    // Backends that can stream answer with one record per line; older ones
+    // still send a single JSON array
+    request.setRawHeader("Accept", "application/x-ndjson, application/json");
+
+    statusLabel->setText("Waiting for server...");
 
     //send GET_Request
-    QNetworkReply* reply = networkManager->get(request,jsonData);
+    m_fetchReply = ApiClient::instance()->send(request, "GET", jsonData);
+    connect(m_fetchReply, &QNetworkReply::readyRead, this, &DataRecordDialog::onFetchReadyRead);
+    connect(m_fetchReply, &QNetworkReply::finished, this, &DataRecordDialog::onFetchFinished);
+}
 
-    QObject::connect(reply,&QNetworkReply::finished,this,[this,reply](){
-        if(reply->error() == QNetworkReply::NoError){
+void DataRecordDialog::startFetch(qint64 fromMs, qint64 toMs, const QString& status)
+{
+    // Rows replace the previous result as they arrive
+    recordModel->clear();
+    exportPDFButton->setEnabled(false);
+    exportCSVButton->setEnabled(false);
+    exportArchiveButton->setEnabled(false);
+
+    ++m_fetchGeneration;
+    m_pendingDecodes = 0;
+    m_fetchInputDone = false;
+    m_fetchMalformed = 0;
+    m_fetchFromMs = fromMs;
+    m_fetchToMs = toMs;
+    m_fetchSettledMs = QDateTime::currentMSecsSinceEpoch() - CACHE_SETTLE_MS;
+    m_fetchPlan.clear();
 
-            QByteArray response = reply->readAll();
-            QJsonDocument doc = QJsonDocument::fromJson(response);
+    // Disable the fetch button while request is in progress
+    fetchButton->setEnabled(false);
+    fetchButton->setText("Fetching...");
+    cancelButton->show();
+    fetchProgress->setRange(0, PROGRESS_STEPS);
+    fetchProgress->setValue(0);
+    fetchProgress->show();
+    statusLabel->setText(status);
+}
 
-            if (doc.isArray()) {
-                QJsonArray dataArray = doc.array();
-                populateTableWithData(dataArray);
+void DataRecordDialog::submitDecode(const std::function<RecordColumns()>& job)
+{
+    const int generation = m_fetchGeneration;
+    ++m_pendingDecodes;
+
+    QFutureWatcher<RecordColumns>* watcher = new QFutureWatcher<RecordColumns>(this);
+    connect(watcher, &QFutureWatcher<RecordColumns>::finished, this, [this, watcher, generation]() {
+        watcher->deleteLater();
+        if (generation != m_fetchGeneration)
+            return;
+
+        --m_pendingDecodes;
+        appendColumns(watcher->result());
+        if (m_fetchInputDone && m_pendingDecodes == 0) {
+            completeFetch();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(&m_decodePool, job));
+}
 
-                // Enable export buttons now that we have data
-                exportPDFButton->setEnabled(true);
-                exportCSVButton->setEnabled(true);
+void DataRecordDialog::cancelFetch()
+{
+    // finished() follows with OperationCanceledError and restores the controls
+    if (m_fetchReply) {
+        m_fetchReply->abort();
+        return;
+    }
 
-                // Scroll to top of table
-                dataTable->verticalScrollBar()->setValue(0);
-            } else {
-                QMessageBox::warning(this, "Error", "Invalid response format from server");
-            }
+    // Only decoding left: drop whatever is still in flight
+    if (m_pendingDecodes > 0) {
+        ++m_fetchGeneration;
+        m_pendingDecodes = 0;
+        statusLabel->setText(QString("Cancelled after %1 records").arg(recordModel->rowCount()));
+        finishFetch();
+    }
+}
 
-        }else{
-            qDebug() << "Error" << reply->errorString();
+void DataRecordDialog::onFetchReadyRead()
+{
+    const QByteArray chunk = m_fetchReply->readAll();
+
+    // The first non-blank byte tells the two reply formats apart
+    if (m_fetchFormat == UnknownFormat) {
+        const QByteArray start = chunk.trimmed();
+        if (start.isEmpty())
+            return;
+        m_fetchFormat = start.startsWith('[') ? JsonArrayFormat : NdjsonFormat;
+        if (m_fetchFormat == JsonArrayFormat) {
+            // Nothing to show before the array is complete
+            fetchProgress->setRange(0, 0);
+            statusLabel->setText("Downloading...");
         }
-        reply->deleteLater();
-
-    });
-
+    }
 
+    if (m_fetchFormat == JsonArrayFormat) {
+        m_fetchBody += chunk;
+        return;
+    }
 
-    // Disable the fetch button while request is in progress
-    fetchButton->setEnabled(false);
-    fetchButton->setText("Fetching...");
+    // Only the line boundaries are found here; parsing happens on the pool
+    const QByteArray lines = m_fetchParser.takeCompleteLines(chunk);
+    if (!lines.isEmpty()) {
+        const qint64 fromMs = m_requestFromMs;
+        const qint64 toMs = m_requestToMs;
+        submitDecode([lines, fromMs, toMs]() { return RecordColumns::fromNdjson(lines).between(fromMs, toMs); });
+    }
 }
 
-void DataRecordDialog::populateTableWithData(const QJsonArray& data)
+void DataRecordDialog::onFetchFinished()
 {
-    // Clear existing table data
-    dataTable->setRowCount(0);
-
-    // Add rows for each data item
-    for (int i = 0; i < data.size(); ++i) {
-        QJsonObject item = data[i].toObject();
-
-        // Add a new row
-        int row = dataTable->rowCount();
-        dataTable->insertRow(row);
-
-        // Timestamp
-        dataTable->setItem(row, 0, new QTableWidgetItem(item["timestamp"].toString()));
-
-        // Calculate total power
-        double p1 = item["p1"].toDouble();
-        double p2 = item["p2"].toDouble();
-        double p3 = item["p3"].toDouble();
-        double totalPower = p1 + p2 + p3;
-
-        // Power values
-        dataTable->setItem(row, 1, new QTableWidgetItem(QString::number(totalPower, 'f', 2)));
-        dataTable->setItem(row, 2, new QTableWidgetItem(QString::number(p1, 'f', 2)));
-        dataTable->setItem(row, 3, new QTableWidgetItem(QString::number(p2, 'f', 2)));
-        dataTable->setItem(row, 4, new QTableWidgetItem(QString::number(p3, 'f', 2)));
-
-        // Calculate total current
-        double c1 = item["c1"].toDouble();
-        double c2 = item["c2"].toDouble();
-        double c3 = item["c3"].toDouble();
-        double totalCurrent = c1 + c2 + c3;
-
-        // Current values
-        dataTable->setItem(row, 5, new QTableWidgetItem(QString::number(totalCurrent, 'f', 2)));
-        dataTable->setItem(row, 6, new QTableWidgetItem(QString::number(c1, 'f', 2)));
-        dataTable->setItem(row, 7, new QTableWidgetItem(QString::number(c2, 'f', 2)));
-        dataTable->setItem(row, 8, new QTableWidgetItem(QString::number(c3, 'f', 2)));
-
-        // Calculate total voltage
-        double v1 = item["v1"].toDouble();
-        double v2 = item["v2"].toDouble();
-        double v3 = item["v3"].toDouble();
-        double totalVoltage = (v1 + v2 + v3) / 3.0; // Average voltage
-
-        // Voltage values
-        dataTable->setItem(row, 9, new QTableWidgetItem(QString::number(totalVoltage, 'f', 2)));
-        dataTable->setItem(row, 10, new QTableWidgetItem(QString::number(v1, 'f', 2)));
-        dataTable->setItem(row, 11, new QTableWidgetItem(QString::number(v2, 'f', 2)));
-        dataTable->setItem(row, 12, new QTableWidgetItem(QString::number(v3, 'f', 2)));
+    QNetworkReply* reply = m_fetchReply;
+    m_fetchReply = nullptr;
+    reply->deleteLater();
+
+    if (reply->error() != QNetworkReply::NoError) {
+        // Batches still decoding belong to a fetch that is over
+        ++m_fetchGeneration;
+        m_pendingDecodes = 0;
+        m_fetchBody.clear();
+
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            statusLabel->setText(QString("Cancelled after %1 records").arg(recordModel->rowCount()));
+            finishFetch();
+            return;
+        }
+
+        statusLabel->setText(QString("Failed after %1 records").arg(recordModel->rowCount()));
+        finishFetch();
+        QMessageBox::warning(this, "Network Error",
+                             QString("Error in network request: %1").arg(reply->errorString()));
+        return;
+    }
+
+    // The server's bounds are inclusive; anything it sends outside the
+    // requested range is already loaded from elsewhere
+    const qint64 fromMs = m_requestFromMs;
+    const qint64 toMs = m_requestToMs;
+    if (m_fetchFormat == JsonArrayFormat) {
+        const QByteArray body = m_fetchBody;
+        m_fetchBody.clear();
+        fetchProgress->setRange(0, PROGRESS_STEPS);
+        statusLabel->setText("Decoding...");
+        submitDecode([body, fromMs, toMs]() { return RecordColumns::fromJsonArray(body).between(fromMs, toMs); });
+    } else {
+        const QByteArray rest = m_fetchParser.takeRemainder();
+        if (!rest.trimmed().isEmpty()) {
+            submitDecode([rest, fromMs, toMs]() { return RecordColumns::fromNdjson(rest).between(fromMs, toMs); });
+        }
     }
 
-    QMessageBox::information(this, "Data Loaded",
-                             QString("Successfully loaded %1 records").arg(dataTable->rowCount()));
+    continueFetch();
 }
 
-void DataRecordDialog::generatePDF()
+void DataRecordDialog::completeFetch()
 {
-    if (dataTable->rowCount() == 0) {
-        QMessageBox::warning(this, "No Data", "There is no data to export.");
+    if (m_fetchFormat == JsonArrayFormat && recordModel->rowCount() == 0 && m_fetchMalformed > 0) {
+        statusLabel->setText("Invalid response");
+        finishFetch();
+        QMessageBox::warning(this, "Error", "Invalid response format from server");
         return;
     }
 
-    QString fileName = QFileDialog::getSaveFileName(this, "Save PDF File",
-                                                    QString("%1_Data_%2.pdf").arg(m_locationName)
-                                                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")),
-                                                    "PDF Files (*.pdf)");
-    if (fileName.isEmpty())
-        return;
+    // A backend answering newest first streams its batches in reverse
+    recordModel->sortByTime();
 
-    QPdfWriter pdfWriter(fileName);
-    pdfWriter.setPageSize(QPageSize(QPageSize::A4));
-    pdfWriter.setPageMargins(QMarginsF(30, 30, 30, 30));
-
-    QPainter painter(&pdfWriter);
-    painter.setPen(Qt::black);
-
-    // Draw header
-    QFont titleFont = painter.font();
-    titleFont.setPointSize(18);
-    titleFont.setBold(true);
-    painter.setFont(titleFont);
-
-    QRect titleRect(0, 100, pdfWriter.width(), 50);
-    painter.drawText(titleRect, Qt::AlignHCenter, QString("Data Report - %1").arg(m_locationName));
-
-    // Draw date range
-    QFont normalFont = painter.font();
-    normalFont.setPointSize(10);
-    normalFont.setBold(false);
-    painter.setFont(normalFont);
-
-    QRect dateRect(0, 200, pdfWriter.width(), 30);
-    painter.drawText(dateRect, Qt::AlignHCenter,
-                     QString("Period: %1 to %2")
-                         .arg(startDateTimeEdit->dateTime().toString("yyyy-MM-dd HH:mm"))
-                         .arg(endDateTimeEdit->dateTime().toString("yyyy-MM-dd HH:mm")));
-
-    // Table header
-    QFont tableHeaderFont = painter.font();
-    tableHeaderFont.setBold(true);
-    painter.setFont(tableHeaderFont);
-
-    int yPos = 300;
-    int rowHeight = 40;
-    int colWidth = pdfWriter.width() / 10;
-
-    // Draw table headers
-    for (int col = 0; col < dataTable->columnCount(); ++col) {
-        QRect headerRect(col * colWidth, yPos, colWidth, rowHeight);
-        painter.drawRect(headerRect);
-        painter.drawText(headerRect, Qt::AlignCenter, dataTable->horizontalHeaderItem(col)->text());
+    // Only complete, settled windows are worth remembering: a skipped record
+    // would stay missing, and recent ones may still be on their way
+    if (m_fetchMalformed == 0) {
+        RecordCache::instance()->insert(m_topic, m_fetchFromMs, qMin(m_fetchToMs + 1, m_fetchSettledMs),
+                                        recordModel->records());
     }
 
-    // Draw table data
-    painter.setFont(normalFont);
-    int maxRowsPerPage = (pdfWriter.height() - yPos - 100) / rowHeight;
-    int currentPage = 1;
-
-    for (int row = 0; row < dataTable->rowCount(); ++row) {
-        // Check if we need a new page
-        if (row > 0 && row % maxRowsPerPage == 0) {
-            painter.end();
-            pdfWriter.newPage();
-            painter.begin(&pdfWriter);
-            painter.setPen(Qt::black);
-            painter.setFont(normalFont);
-
-            // Reset yPos for new page and draw header
-            yPos = 100;
-            currentPage++;
-
-            // Draw page header on new page
-            painter.setFont(tableHeaderFont);
-            for (int col = 0; col < dataTable->columnCount(); ++col) {
-                QRect headerRect(col * colWidth, yPos, colWidth, rowHeight);
-                painter.drawRect(headerRect);
-                painter.drawText(headerRect, Qt::AlignCenter, dataTable->horizontalHeaderItem(col)->text());
-            }
-            painter.setFont(normalFont);
-            yPos += rowHeight;
-        } else if (row > 0) {
-            yPos += rowHeight;
-        } else {
-            yPos += rowHeight;
-        }
+    QString status = QString("Loaded %1 records").arg(recordModel->rowCount());
+    if (m_fetchMalformed > 0) {
+        status += QString(", skipped %1 malformed").arg(m_fetchMalformed);
+    }
+    statusLabel->setText(status);
 
-        // Draw row data
-        for (int col = 0; col < dataTable->columnCount(); ++col) {
-            QTableWidgetItem* item = dataTable->item(row, col);
-            QRect cellRect(col * colWidth, yPos, colWidth, rowHeight);
-            painter.drawRect(cellRect);
-            if (item) {
-                painter.drawText(cellRect, Qt::AlignCenter, item->text());
-            }
-        }
+    // An export may have been waiting for these records
+    const std::function<void()> next = m_afterFetch;
+    finishFetch();
+    if (next) {
+        next();
     }
+}
 
-    painter.end();
+void DataRecordDialog::finishFetch()
+{
+    // Every way out of a fetch ends here, so the button can't stay stuck
+    m_afterFetch = nullptr;
+    fetchButton->setEnabled(true);
+    fetchButton->setText("Fetch Data");
+    cancelButton->hide();
+    fetchProgress->hide();
 
-    QMessageBox::information(this, "PDF Created",
-                             QString("PDF file has been saved to:\n%1").arg(fileName));
+    if (recordModel->rowCount() > 0) {
+        showFetchedData();
+    }
 
-    // Open the PDF file
-    QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
+    // Server latency so far, on hover
+    statusLabel->setToolTip(ApiClient::instance()->statsSummary());
 }
 
-void DataRecordDialog::handleNetworkReply(QNetworkReply* reply)
+void DataRecordDialog::appendColumns(const RecordColumns& batch)
 {
-    // Check for errors in the network reply
-    if (reply->error() != QNetworkReply::NoError) {
-        QMessageBox::warning(this, "Network Error",
-                             QString("Error in network request: %1").arg(reply->errorString()));
-        fetchButton->setEnabled(true);
-        fetchButton->setText("Fetch Data");
-        reply->deleteLater();
+    m_fetchMalformed += batch.malformed;
+    if (batch.isEmpty())
         return;
-    }
 
-    // Read the response data
-    QByteArray responseData = reply->readAll();
+    // The batch arrives complete, totals included; this is just array copies
+    const bool firstRows = recordModel->rowCount() == 0;
+    recordModel->appendColumns(batch);
 
-    // Parse JSON response
-    QJsonDocument doc = QJsonDocument::fromJson(responseData);
-    if (!doc.isArray()) {
-        QMessageBox::warning(this, "Error", "Invalid response format from server");
-        fetchButton->setEnabled(true);
-        fetchButton->setText("Fetch Data");
-        reply->deleteLater();
-        return;
+    if (firstRows) {
+        dataTable->resizeColumnsToContents();
     }
 
-    // Process the data
-    QJsonArray dataArray = doc.array();
-    populateTableWithData(dataArray);
+    // Rows arrive in time order, so the newest one says how far along we are
+    if (m_fetchToMs > m_fetchFromMs) {
+        const qint64 reached = batch.timestamps.last() - m_fetchFromMs;
+        fetchProgress->setValue(int(qBound<qint64>(0, reached * PROGRESS_STEPS / (m_fetchToMs - m_fetchFromMs),
+                                                   PROGRESS_STEPS)));
+        statusLabel->setText(QString("Loading... %1 records").arg(recordModel->rowCount()));
+    }
+}
 
+void DataRecordDialog::showFetchedData()
+{
     // Enable export buttons now that we have data
     exportPDFButton->setEnabled(true);
     exportCSVButton->setEnabled(true);
+    exportArchiveButton->setEnabled(true);
 
     // Scroll to top of table
     dataTable->verticalScrollBar()->setValue(0);
+}
 
-    // Re-enable the fetch button
-    fetchButton->setEnabled(true);
-    fetchButton->setText("Fetch Data");
+bool DataRecordDialog::recordsReady(const std::function<void()>& retry)
+{
+    if (!m_recordsStale)
+        return true;
+
+    // The table still holds an earlier period; load the selected one first
+    m_afterFetch = retry;
+    if (viewTabs->currentWidget() == dataTable) {
+        fetchRecords();
+    } else {
+        viewTabs->setCurrentWidget(dataTable);
+    }
+    return false;
+}
 
-    // Clean up
-    reply->deleteLater();
+void DataRecordDialog::generatePDF()
+{
+    if (!recordsReady([this]() { generatePDF(); }))
+        return;
+
+    if (recordModel->rowCount() == 0) {
+        QMessageBox::warning(this, "No Data", "There is no data to export.");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(this, "Save PDF File",
+                                                    QString("%1_Data_%2.pdf").arg(m_locationName)
+                                                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")),
+                                                    "PDF Files (*.pdf)");
+    if (fileName.isEmpty())
+        return;
+
+    // QPicture's logical DPI becomes the writer's resolution, so the pages
+    // rendered into pictures replay at their true size
+    PdfReportEngine::Report report;
+    report.fileName = fileName;
+    report.title = QString("Data Report - %1").arg(m_locationName);
+    report.period = QString("Period: %1 to %2")
+                        .arg(startDateTimeEdit->dateTime().toString("yyyy-MM-dd HH:mm"))
+                        .arg(endDateTimeEdit->dateTime().toString("yyyy-MM-dd HH:mm"));
+    report.color = m_locationColor;
+    report.dpi = QPicture().logicalDpiY();
+    report.records = recordModel->records();
+
+    // The engine fans pages out on the global pool, so it runs on a pool of
+    // its own
+    m_reportFuture = QtConcurrent::run(&m_reportPool, &PdfReportEngine::render, report);
+
+    QProgressDialog* progress = new QProgressDialog("Generating PDF...", "Cancel", 0, PdfReportEngine::PROGRESS_STEPS, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+
+    QFutureWatcher<PdfReportEngine::Result>* watcher = new QFutureWatcher<PdfReportEngine::Result>(this);
+    connect(watcher, &QFutureWatcher<PdfReportEngine::Result>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<PdfReportEngine::Result>::cancel);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    connect(watcher, &QFutureWatcher<PdfReportEngine::Result>::finished, this, [this, watcher, progress, fileName, elapsed]() {
+        watcher->deleteLater();
+        progress->deleteLater();
+
+        // A cancelled report leaves no result and no file
+        if (watcher->future().resultCount() == 0) {
+            statusLabel->setText("PDF export cancelled");
+            return;
+        }
+
+        const PdfReportEngine::Result result = watcher->result();
+        if (!result.error.isEmpty()) {
+            QMessageBox::critical(this, "Error", QString("Could not write file: %1").arg(result.error));
+            return;
+        }
+
+        statusLabel->setText(QString("Exported %1 pages in %2 s")
+                                 .arg(result.pages)
+                                 .arg(elapsed.elapsed() / 1000.0, 0, 'f', 1));
+        QMessageBox::information(this, "PDF Created",
+                                 QString("PDF file has been saved to:\n%1").arg(fileName));
+
+        // Open the PDF file
+        QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
+    });
+    watcher->setFuture(m_reportFuture);
+}
+
+bool DataRecordDialog::storeCovers(qint64 fromMs, qint64 toMs) const
+{
+    // An opened archive is exported as it is, whatever is stored here
+    if (m_showingArchive)
+        return false;
+
+    // The selected end is included
+    return SampleStore().covers(m_topic, fromMs, toMs + 1);
 }
 
 void DataRecordDialog::exportCSV()
 {
-    if (dataTable->rowCount() == 0) {
+    // The local store can supply the selected period when it holds all of
+    // it; otherwise the export is what the table holds, with any gaps filled
+    // in from the backend
+    const qint64 fromMs = startDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    const qint64 toMs = endDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    const bool fromStore = storeCovers(fromMs, toMs);
+    if (!fromStore && !recordsReady([this]() { exportCSV(); }))
+        return;
+
+    if (!fromStore && recordModel->rowCount() == 0) {
         QMessageBox::warning(this, "No Data", "There is no data to export.");
         return;
     }
@@ -390,47 +616,170 @@ void DataRecordDialog::exportCSV()
     if (fileName.isEmpty())
         return;
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "Error", "Could not open file for writing.");
-        return;
+    QStringList headers;
+    for (int col = 0; col < recordModel->columnCount(); ++col) {
+        headers << recordModel->headerText(col);
     }
 
-    QTextStream out(&file);
-
-    // Write header
-    QStringList headers;
-    for (int col = 0; col < dataTable->columnCount(); ++col) {
-        headers << dataTable->horizontalHeaderItem(col)->text();
+    // Written on the global pool; the table's columns are implicitly shared,
+    // so handing them over copies nothing
+    QFuture<CsvExporter::Result> future;
+    if (fromStore) {
+        future = QtConcurrent::run(&CsvExporter::exportStore, fileName, headers, m_topic, fromMs, toMs);
+    } else {
+        future = QtConcurrent::run(&CsvExporter::exportColumns, fileName, headers, recordModel->records());
     }
-    out << headers.join(",") << "\n";
-
-    // Write data
-    for (int row = 0; row < dataTable->rowCount(); ++row) {
-        QStringList rowData;
-        for (int col = 0; col < dataTable->columnCount(); ++col) {
-            QTableWidgetItem* item = dataTable->item(row, col);
-            if (item) {
-                // Quote data if it contains commas
-                QString text = item->text();
-                if (text.contains(",")) {
-                    rowData << "\"" + text + "\"";
-                } else {
-                    rowData << text;
-                }
-            } else {
-                rowData << "";
-            }
+
+    QProgressDialog* progress = new QProgressDialog("Exporting CSV...", "Cancel", 0, CsvExporter::PROGRESS_STEPS, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+
+    QFutureWatcher<CsvExporter::Result>* watcher = new QFutureWatcher<CsvExporter::Result>(this);
+    connect(watcher, &QFutureWatcher<CsvExporter::Result>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<CsvExporter::Result>::cancel);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    connect(watcher, &QFutureWatcher<CsvExporter::Result>::finished, this, [this, watcher, progress, fileName, elapsed]() {
+        watcher->deleteLater();
+        progress->deleteLater();
+
+        // A cancelled export leaves no result and no file
+        if (watcher->future().resultCount() == 0) {
+            statusLabel->setText("CSV export cancelled");
+            return;
         }
-        out << rowData.join(",") << "\n";
+
+        const CsvExporter::Result result = watcher->result();
+        if (!result.error.isEmpty()) {
+            QMessageBox::critical(this, "Error", QString("Could not write file: %1").arg(result.error));
+            return;
+        }
+
+        statusLabel->setText(QString("Exported %1 records in %2 s")
+                                 .arg(result.rows)
+                                 .arg(elapsed.elapsed() / 1000.0, 0, 'f', 1));
+        QMessageBox::information(this, "CSV Created",
+                                 QString("CSV file has been saved to:\n%1").arg(fileName));
+
+        // Open the CSV file
+        QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
+    });
+    watcher->setFuture(future);
+}
+
+void DataRecordDialog::exportArchive()
+{
+    // Same sources as the CSV export
+    const qint64 fromMs = startDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    const qint64 toMs = endDateTimeEdit->dateTime().toMSecsSinceEpoch();
+    const bool fromStore = storeCovers(fromMs, toMs);
+    if (!fromStore && !recordsReady([this]() { exportArchive(); }))
+        return;
+
+    if (!fromStore && recordModel->rowCount() == 0) {
+        QMessageBox::warning(this, "No Data", "There is no data to export.");
+        return;
     }
 
-    file.close();
+    QString fileName = QFileDialog::getSaveFileName(this, "Save Record Archive",
+                                                    QString("%1_Data_%2.prca").arg(m_locationName)
+                                                        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss")),
+                                                    "Record Archives (*.prca)");
+    if (fileName.isEmpty())
+        return;
+
+    QFuture<RecordArchive::Result> future;
+    if (fromStore) {
+        future = QtConcurrent::run(&RecordArchive::exportStore, fileName, m_topic, fromMs, toMs);
+    } else {
+        future = QtConcurrent::run(&RecordArchive::exportColumns, fileName,
+                                   m_showingArchive ? m_archiveTopic : m_topic, recordModel->records());
+    }
 
-    QMessageBox::information(this, "CSV Created",
-                             QString("CSV file has been saved to:\n%1").arg(fileName));
+    QProgressDialog* progress = new QProgressDialog("Exporting archive...", "Cancel", 0, RecordArchive::PROGRESS_STEPS, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
 
-    // Open the CSV file
-    QDesktopServices::openUrl(QUrl::fromLocalFile(fileName));
+    QFutureWatcher<RecordArchive::Result>* watcher = new QFutureWatcher<RecordArchive::Result>(this);
+    connect(watcher, &QFutureWatcher<RecordArchive::Result>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, watcher, &QFutureWatcher<RecordArchive::Result>::cancel);
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    connect(watcher, &QFutureWatcher<RecordArchive::Result>::finished, this, [this, watcher, progress, fileName, elapsed]() {
+        watcher->deleteLater();
+        progress->deleteLater();
+
+        // A cancelled export leaves no result and no file
+        if (watcher->future().resultCount() == 0) {
+            statusLabel->setText("Archive export cancelled");
+            return;
+        }
+
+        const RecordArchive::Result result = watcher->result();
+        if (!result.error.isEmpty()) {
+            QMessageBox::critical(this, "Error", QString("Could not write file: %1").arg(result.error));
+            return;
+        }
+
+        statusLabel->setText(QString("Exported %1 records in %2 s (%3)")
+                                 .arg(result.rows)
+                                 .arg(elapsed.elapsed() / 1000.0, 0, 'f', 1)
+                                 .arg(QLocale().formattedDataSize(QFileInfo(fileName).size())));
+    });
+    watcher->setFuture(future);
 }
 
+void DataRecordDialog::openArchive()
+{
+    if (m_fetchReply || m_pendingDecodes > 0)
+        return;
+
+    const QString fileName = QFileDialog::getOpenFileName(this, "Open Record Archive", QString(),
+                                                          "Record Archives (*.prca)");
+    if (fileName.isEmpty())
+        return;
+
+    // Decoded on the decode pool; row groups fan out from there
+    startFetch(0, 0, "Opening archive...");
+    fetchProgress->setRange(0, 0);
+    const int generation = m_fetchGeneration;
+    ++m_pendingDecodes;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QFutureWatcher<RecordArchive::Contents>* watcher = new QFutureWatcher<RecordArchive::Contents>(this);
+    connect(watcher, &QFutureWatcher<RecordArchive::Contents>::finished, this, [this, watcher, generation, fileName, elapsed]() {
+        watcher->deleteLater();
+        if (generation != m_fetchGeneration)
+            return;
+
+        m_pendingDecodes = 0;
+        const RecordArchive::Contents contents = watcher->result();
+        if (!contents.error.isEmpty()) {
+            statusLabel->setText("Could not open archive");
+            finishFetch();
+            QMessageBox::warning(this, "Error", QString("Could not open %1: %2").arg(fileName, contents.error));
+            return;
+        }
+
+        // Shown in place of fetched data until the next fetch
+        m_showingArchive = true;
+        m_recordsStale = false;
+        m_archiveTopic = contents.topic;
+        appendColumns(contents.records);
+        if (!contents.records.isEmpty()) {
+            startDateTimeEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(contents.records.timestamps.first()));
+            endDateTimeEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(contents.records.timestamps.last()));
+        }
+        historyChart->showRecords(contents.records);
+
+        statusLabel->setText(QString("Opened %1 records of %2 in %3 s")
+                                 .arg(contents.records.size())
+                                 .arg(contents.topic)
+                                 .arg(elapsed.elapsed() / 1000.0, 0, 'f', 1));
+        finishFetch();
+    });
+    watcher->setFuture(QtConcurrent::run(&m_decodePool, &RecordArchive::load, fileName));
+}
@@ -7,17 +7,28 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QDateTimeEdit>
-#include <QTableWidget>
-#include <QNetworkAccessManager>
+#include <QTableView>
+#include <QTabWidget>
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
-#include <QtWebSockets/QWebSocket>
 #include <QPrinter>
 #include <QPrintDialog>
 #include <QPainter>
 #include <QFileDialog>
+#include <QProgressBar>
+#include <QPointer>
+#include <QFuture>
+#include <QThreadPool>
+#include <functional>
+#include "ChannelSchema.h"
+#include "SampleStore.h"
+#include "RecordStreamParser.h"
+#include "HistoryChart.h"
+#include "PdfReportEngine.h"
+#include "RecordCache.h"
+#include "RecordTableModel.h"
 
 class DataRecordDialog : public QDialog
 {
@@ -25,33 +36,108 @@ class DataRecordDialog : public QDialog
 
 public:
     DataRecordDialog(QWidget* parent, int locationIndex, const QString& locationName,
-                     QColor locationColor, QString& topic, QWebSocket* socket);
+                     QColor locationColor, QString& topic);
     ~DataRecordDialog();
 
 private slots:
     void fetchData();
-    void handleNetworkReply(QNetworkReply* reply);
+    void onViewChanged();
+    void cancelFetch();
+    void onFetchReadyRead();
+    void onFetchFinished();
     void generatePDF();
     void exportCSV();
+    void exportArchive();
+    void openArchive();
 
 private:
     void setupUI();
-    void populateTableWithData(const QJsonArray& data);
+    // Raw rows of the selected period, for the records tab and the exports
+    void fetchRecords();
+    void startFetch(qint64 fromMs, qint64 toMs, const QString& status);
+    // Loads the next pieces of the plan, up to the first one the backend has
+    // to send; completes the fetch once the plan is done
+    void continueFetch();
+    void requestRange(qint64 fromMs, qint64 toMs);
+    // Runs a decode job on the decode pool; its batch is appended when done
+    void submitDecode(const std::function<RecordColumns()>& job);
+    void appendColumns(const RecordColumns& batch);
+    // Called when the reply is complete and every batch has been appended
+    void completeFetch();
+    void showFetchedData();
+    // Whether the table holds the selected period. If not, its records are
+    // fetched and retry runs once they are all in.
+    bool recordsReady(const std::function<void()>& retry);
+    // Whether exports of the period can read the local store rather than
+    // what the table holds: it has to hold all of it, without gaps
+    bool storeCovers(qint64 fromMs, qint64 toMs) const;
+    // Restores the controls after a fetch completed, failed or was cancelled
+    void finishFetch();
 
     QVBoxLayout* mainLayout;
-    QTableWidget* dataTable;
+    QTabWidget* viewTabs;
+    HistoryChart* historyChart;
+    QTableView* dataTable;
+    RecordTableModel* recordModel;
     QDateTimeEdit* startDateTimeEdit;
     QDateTimeEdit* endDateTimeEdit;
     QPushButton* fetchButton;
+    QPushButton* cancelButton;
+    QProgressBar* fetchProgress;
+    QLabel* statusLabel;
     QPushButton* exportPDFButton;
     QPushButton* exportCSVButton;
-    QNetworkAccessManager* networkManager;
+    QPushButton* exportArchiveButton;
 
     int m_locationIndex;
     QString m_locationName;
     QColor m_locationColor;
     QString m_topic;
-    QWebSocket* m_socket;
+    // Sent with every request for the topic's history
+    QString m_clusterId = "1";   // HAVE TO WORK OUT
+    // The period changed since the rows were last fetched
+    bool m_recordsStale = true;
+    // Export waiting for the running fetch to complete
+    std::function<void()> m_afterFetch;
+    // The table holds an opened record archive, of m_archiveTopic
+    bool m_showingArchive = false;
+    QString m_archiveTopic;
+
+    // How the backend answered: NDJSON is parsed as it streams in, a legacy
+    // JSON array can only be parsed once complete
+    enum ReplyFormat { UnknownFormat, NdjsonFormat, JsonArrayFormat };
+
+    static const int PROGRESS_STEPS = 1000;
+
+    QPointer<QNetworkReply> m_fetchReply;
+    ReplyFormat m_fetchFormat = UnknownFormat;
+    RecordStreamParser m_fetchParser;
+    QByteArray m_fetchBody;
+    qint64 m_fetchFromMs = 0;
+    qint64 m_fetchToMs = 0;
+    // What is left of the window, in time order: pieces from RecordCache and
+    // gaps, which come from the local store where it covers them and from
+    // the backend elsewhere
+    QVector<RecordCache::Piece> m_fetchPlan;
+    QVector<SampleStore::Span> m_fetchCoverage;
+    qint64 m_requestFromMs = 0;
+    qint64 m_requestToMs = 0;
+    // The cache only keeps records older than this, taken when the fetch starts
+    qint64 m_fetchSettledMs = 0;
+    static constexpr qint64 CACHE_SETTLE_MS = 60 * 1000;
+
+    // Decoding and totals run here, off the GUI thread. A single thread keeps
+    // batches in order; results of an abandoned fetch are recognised by their
+    // generation and dropped.
+    QThreadPool m_decodePool;
+    int m_fetchGeneration = 0;
+    int m_pendingDecodes = 0;
+    bool m_fetchInputDone = false;
+    int m_fetchMalformed = 0;
+
+    // PDF reports; see PdfReportEngine
+    QThreadPool m_reportPool;
+    QFuture<PdfReportEngine::Result> m_reportFuture;
 };
 
 #endif // DATARECORDDIALOG_H
@@ -8,27 +8,68 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QTextEdit>
+#include <QLocale>
+#include <QHeaderView>
+#include <QThread>
+#include <QThreadPool>
 #include "LocationDetailDialog.h"
 #include "ModernGaugeWidget.h"
 #include "ScheduleManagerDialog.h"
+#include "SpscQueue.h"
+
+// Shared by a cluster and the pool thread reading its stored history, so
+// either may finish first
+struct StoredHistoryLoader {
+    static const int QUEUE_CAPACITY = 16384;
+
+    SpscQueue<PowerSample> queue{QUEUE_CAPACITY};
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> done{false};
+};
+
+static const int STORED_HISTORY_DRAIN_MS = 16;
+
+// Every location's window, oldest first, with the location index in topicId.
+// A full queue means the GUI thread is behind; the reader waits for it.
+static void readStoredHistory(QSharedPointer<StoredHistoryLoader> loader, const QStringList& topics,
+                              const QVector<qint64>& fromMs, qint64 toMs)
+{
+    const SampleStore store;
+    for (int location = 0; location < topics.size(); ++location) {
+        store.query(topics[location], fromMs[location], toMs, [&loader, location](PowerSample sample) {
+            sample.topicId = location;
+            while (!loader->cancelled.load(std::memory_order_relaxed) && !loader->queue.push(sample)) {
+                QThread::msleep(STORED_HISTORY_DRAIN_MS);
+            }
+        });
+        if (loader->cancelled.load(std::memory_order_relaxed))
+            break;
+    }
+    loader->done.store(true, std::memory_order_release);
+}
 
 Cluster::Cluster(QWidget *parent)
-    : QMainWindow(parent), dataPointCount(0)
+    : QMainWindow(parent), ingest(nullptr), dataPointCount(0), yAxisRanges(LocationStats::ChartCount)
 {
     // Don't call setupUI() here anymore as it will be called by MainWindow
 }
 
 Cluster::~Cluster()
 {
-    for (auto series : powerSeries) {
-        delete series;
+    // The reader may still be going; it drops the rest and ends on its own
+    if (storedHistory) {
+        storedHistory->cancelled.store(true, std::memory_order_relaxed);
     }
 
-    for (auto series : voltageSeries){
-        delete series;
+    // Release our share of the backend subscriptions
+    if (ingest) {
+        ingest->bus()->unsubscribeAll(this);
+        for (LocationStats* location : locationStats) {
+            ingest->unsubscribe(location->topicId);
+        }
     }
 
-    for (auto series : currentSeries){
+    for (auto series : chartSeries) {
         delete series;
     }
 
@@ -80,8 +121,7 @@ void Cluster::showDataRecorder(int locationIndex)
         locationIndex,
         locationStats[locationIndex]->name,
         locationStats[locationIndex]->color,
-        locationStats[locationIndex]->topic,
-        locationStats[locationIndex]->socket
+        locationStats[locationIndex]->topic
         );
 
     // Set dialog to delete itself when closed
@@ -102,8 +142,7 @@ void Cluster::showScheduleManager(int locationIndex)
         locationIndex,
         locationStats[locationIndex]->name,
         locationStats[locationIndex]->color,
-        locationStats[locationIndex]->topic,
-        locationStats[locationIndex]->socket
+        locationStats[locationIndex]->topic
         );
 
     // Connect the signal to handle schedule changes
@@ -149,13 +188,31 @@ void Cluster::createBuildingsSection()
     seriesLabel->setStyleSheet("color: white;");
 
     QComboBox* seriesSelector = new QComboBox();
-    seriesSelector->addItem("Power");
-    seriesSelector->addItem("Voltage");
-    seriesSelector->addItem("Current");
+    for (ChannelSchema::Quantity quantity : ChannelSchema::ChartQuantities) {
+        seriesSelector->addItem(ChannelSchema::Quantities[quantity].name);
+    }
     seriesSelector->setStyleSheet("background-color: #333; color: white; padding: 5px;");
 
+    // Length of history shown; long windows are drawn from LOD summaries
+    QLabel* windowLabel = new QLabel("Window:");
+    windowLabel->setStyleSheet("color: white;");
+
+    QComboBox* windowSelector = new QComboBox();
+    windowSelector->addItem("2 minutes", qint64(2) * 60 * 1000);
+    windowSelector->addItem("15 minutes", qint64(15) * 60 * 1000);
+    windowSelector->addItem("1 hour", qint64(60) * 60 * 1000);
+    windowSelector->addItem("6 hours", qint64(6) * 60 * 60 * 1000);
+    windowSelector->addItem("1 day", qint64(24) * 60 * 60 * 1000);
+    windowSelector->addItem("3 days", qint64(3) * 24 * 60 * 60 * 1000);
+    windowSelector->setStyleSheet("background-color: #333; color: white; padding: 5px;");
+    connect(windowSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, windowSelector](int index) {
+        setChartWindow(windowSelector->itemData(index).toLongLong());
+    });
+
     controlLayout->addWidget(seriesLabel);
     controlLayout->addWidget(seriesSelector);
+    controlLayout->addWidget(windowLabel);
+    controlLayout->addWidget(windowSelector);
     controlLayout->addStretch();
 
     buildingsLayout->addLayout(controlLayout);
@@ -176,374 +233,245 @@ void Cluster::createBuildingsSection()
     }
 
 
-    QGridLayout* locationGridLayout = new QGridLayout();
+    // Actions on the location selected in the overview
+    QHBoxLayout* actionLayout = new QHBoxLayout();
+
+    QPushButton* detailsButton = new QPushButton("Details");
+    detailsButton->setStyleSheet("background-color: #27ae60; color: white;");
+    connect(detailsButton, &QPushButton::clicked, this, [this]() { showLocationDetails(currentLocation()); });
+
+    QPushButton* timerButton = new QPushButton("Set Timer");
+    timerButton->setStyleSheet("background-color: #2980b9; color: white;");
+    connect(timerButton, &QPushButton::clicked, this, [this]() { showScheduleManager(currentLocation()); });
+
+    QPushButton* recordButton = new QPushButton("Record Data");
+    recordButton->setStyleSheet("background-color: #e74c3c; color: white;");
+    connect(recordButton, &QPushButton::clicked, this, [this]() { showDataRecorder(currentLocation()); });
+
+    actionLayout->addWidget(detailsButton);
+    actionLayout->addWidget(timerButton);
+    actionLayout->addWidget(recordButton);
+    actionLayout->addStretch();
+
+    buildingsLayout->addLayout(actionLayout);
+
+    // One row per location instead of a widget grid, so a cluster with
+    // hundreds of locations costs no more than the rows on screen
+    locationModel = new LocationTableModel(this);
+    locationModel->setLocations(locationStats);
+
+    locationView = new QTableView();
+    locationView->setModel(locationModel);
+    locationView->setItemDelegate(new LocationOverviewDelegate(locationView));
+    locationView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    locationView->setSelectionMode(QAbstractItemView::SingleSelection);
+    locationView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    locationView->setShowGrid(false);
+    locationView->setWordWrap(false);
+    locationView->setContextMenuPolicy(Qt::CustomContextMenu);
+    locationView->setStyleSheet("QTableView { background-color: #1e1e1e; color: white; selection-background-color: #444; border: none; }"
+                                "QHeaderView::section { background-color: #333; color: white; padding: 4px; border: none; }");
+
+    // Fixed row heights and column widths: nothing is measured per row
+    locationView->verticalHeader()->hide();
+    locationView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    locationView->verticalHeader()->setDefaultSectionSize(LocationOverviewDelegate::ROW_HEIGHT);
+    locationView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    locationView->horizontalHeader()->setDefaultSectionSize(120);
+    locationView->horizontalHeader()->setSectionResizeMode(LocationTableModel::TrendColumn, QHeaderView::Stretch);
+    locationView->setMinimumHeight(4 * LocationOverviewDelegate::ROW_HEIGHT);
+
+    connect(locationView, &QTableView::doubleClicked, this, [this](const QModelIndex& index) {
+        showLocationDetails(index.row());
+    });
+    connect(locationView, &QTableView::customContextMenuRequested, this, [this](const QPoint& pos) {
+        const int row = locationView->indexAt(pos).row();
+        if (row < 0)
+            return;
+
+        QMenu menu(this);
+        QAction* detailsAction = menu.addAction("Details");
+        QAction* timerAction = menu.addAction("Set Timer");
+        QAction* recordAction = menu.addAction("Record Data");
+
+        QAction* chosen = menu.exec(locationView->viewport()->mapToGlobal(pos));
+        if (chosen == detailsAction) {
+            showLocationDetails(row);
+        } else if (chosen == timerAction) {
+            showScheduleManager(row);
+        } else if (chosen == recordAction) {
+            showDataRecorder(row);
+        }
+    });
 
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLabel* locationLabel = new QLabel(QString("%1").arg(locationStats[i]->name));
-        QPalette palette = locationLabel->palette();
-        palette.setColor(QPalette::WindowText, locationStats[i]->color);
-        locationLabel->setPalette(palette);
-        locationLabels.append(locationLabel);
-
-        // Location Button
-        QPushButton* locationButton = new QPushButton(locationStats[i]->name);
-        locationButton->setStyleSheet(QString("background-color: %1; color: white;").arg(locationStats[i]->color.name()));
-        connect(locationButton, &QPushButton::clicked, this, [this, i]() { showLocationDetails(i); });
-
-        // Timer Button
-        QPushButton* timerButton = new QPushButton("Set Timer");
-        timerButton->setStyleSheet("background-color: #2980b9; color: white;");
-        connect(timerButton, &QPushButton::clicked, this, [this, i]() { showScheduleManager(i); });
-
-        // Record Data Button (new)
-        QPushButton* recordButton = new QPushButton("Record Data");
-        recordButton->setStyleSheet("background-color: #e74c3c; color: white;");
-        connect(recordButton, &QPushButton::clicked, this, [this, i]() { showDataRecorder(i); });
-
-        // Create a horizontal layout for buttons
-        QHBoxLayout* buttonLayout = new QHBoxLayout();
-        buttonLayout->addWidget(locationButton);
-        buttonLayout->addWidget(timerButton);
-        buttonLayout->addWidget(recordButton); // Add the new button
-
-        // Create a widget to hold the buttons layout
-        QWidget* buttonWidget = new QWidget();
-        buttonWidget->setLayout(buttonLayout);
-
-        int row = 1;
-        int col = i;
-
-        // Add buttons side by side
-        locationGridLayout->addWidget(buttonWidget, row, col * 2);
-        // Add label to the right of buttons
-        locationGridLayout->addWidget(locationLabel, row, col * 2 + 1);
-    }
+    buildingsLayout->addWidget(locationView, 1);
 
+    // Create stack widget to hold different charts
+    chartStackWidget = new QStackedWidget();
 
+    // One chart per schema quantity; axes and series are generated from
+    // ChannelSchema so adding a channel needs no changes here
+    for (int chart = 0; chart < LocationStats::ChartCount; ++chart) {
+        const ChannelSchema::Quantity quantity = ChannelSchema::ChartQuantities[chart];
+
+        charts[chart] = new QChart();
+        charts[chart]->setTitle(ChannelSchema::Quantities[quantity].chartTitle);
+        charts[chart]->legend()->hide();
+        charts[chart]->setBackgroundBrush(QBrush(QColor("#1e1e1e")));
+        charts[chart]->setTitleBrush(QBrush(QColor("white")));
+
+        timeAxes[chart] = new QDateTimeAxis();
+        timeAxes[chart]->setFormat("hh:mm:ss");
+        timeAxes[chart]->setTitleText("Time");
+        timeAxes[chart]->setLabelsColor(QColor("white"));
+        timeAxes[chart]->setTitleBrush(QBrush(QColor("white")));
+
+        QValueAxis* axisY = new QValueAxis();
+        axisY->setRange(0, 100);
+        axisY->setLabelFormat("%d");
+        axisY->setTitleText(ChannelSchema::axisTitle(quantity));
+        axisY->setLabelsColor(QColor("white"));
+        axisY->setTitleBrush(QBrush(QColor("white")));
+
+        charts[chart]->addAxis(timeAxes[chart], Qt::AlignBottom);
+        charts[chart]->addAxis(axisY, Qt::AlignLeft);
+
+        auto addSeries = [&](LocationStats* location, QLineSeries* series) {
+            series->setName(location->name);
+            series->setPen(QPen(location->color, 2));
+            charts[chart]->addSeries(series);
+            series->attachAxis(timeAxes[chart]);
+            series->attachAxis(axisY);
+            chartSeries.append(series);
+        };
+
+        // Aggregate series of every location first, then their phases
+        for (LocationStats* location : locationStats) {
+            addSeries(location, location->aggregateSeries[chart]);
+        }
 
-    buildingsLayout->addLayout(locationGridLayout);
+        const int first = ChannelSchema::firstChannel(quantity);
+        const int last = first + ChannelSchema::channelCount(quantity);
+        for (LocationStats* location : locationStats) {
+            for (int channel = first; channel < last; ++channel) {
+                addSeries(location, location->channelSeries[channel]);
+            }
+        }
 
-    // Create stack widget to hold different charts
-    chartStackWidget = new QStackedWidget();
+        chartViews[chart] = new QChartView(charts[chart]);
+        chartViews[chart]->setRenderHint(QPainter::Antialiasing);
+        chartViews[chart]->setStyleSheet("background-color: #1e1e1e;");
 
-    // Create power usage chart
-    powerChart = new QChart();
-    powerChart->setTitle("Power Usage");
-    powerChart->legend()->hide();
-    powerChart->setBackgroundBrush(QBrush(QColor("#1e1e1e")));
-    powerChart->setTitleBrush(QBrush(QColor("white")));
-
-    // Use QDateTimeAxis for X axis instead of QValueAxis
-    QDateTime startTime = QDateTime::currentDateTime();
-    QDateTime endTime = startTime.addSecs(MAX_DATA_POINTS);
-
-    // Power chart time axis
-    powerTimeAxis = new QDateTimeAxis();
-    // powerTimeAxis->setRange(startTime, endTime);
-    powerTimeAxis->setFormat("hh:mm:ss");
-    powerTimeAxis->setTitleText("Time");
-    powerTimeAxis->setLabelsColor(QColor("white"));
-    powerTimeAxis->setTitleBrush(QBrush(QColor("white")));
-
-    QValueAxis* powerAxisY = new QValueAxis();
-    powerAxisY->setRange(0, 100);
-    powerAxisY->setLabelFormat("%d");
-    powerAxisY->setTitleText("Power (W)");
-    powerAxisY->setLabelsColor(QColor("white"));
-    powerAxisY->setTitleBrush(QBrush(QColor("white")));
-
-    powerChart->addAxis(powerTimeAxis, Qt::AlignBottom);
-    powerChart->addAxis(powerAxisY, Qt::AlignLeft);
-
-    // Create series for each location - power
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series = locationStats[i]->powerSeries;
-        series->setName(locationStats[i]->name);
-        series->setPen(QPen(locationStats[i]->color, 2));
-        powerChart->addSeries(series);
-        series->attachAxis(powerTimeAxis);
-        series->attachAxis(powerAxisY);
-        powerSeries.append(series);
+        // Add chart views to stack widget
+        chartStackWidget->addWidget(chartViews[chart]);
     }
 
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series1 = locationStats[i]->p1;
-        series1->setName(locationStats[i]->name);
-        series1->setPen(QPen(locationStats[i]->color, 2));
-        powerChart->addSeries(series1);
-        series1->attachAxis(powerTimeAxis);
-        series1->attachAxis(powerAxisY);
-        powerSeries.append(series1);
-
-        QLineSeries* series2 = locationStats[i]->p2;
-        series2->setName(locationStats[i]->name);
-        series2->setPen(QPen(locationStats[i]->color, 2));
-        powerChart->addSeries(series2);
-        series2->attachAxis(powerTimeAxis);
-        series2->attachAxis(powerAxisY);
-        powerSeries.append(series2);
-
-        QLineSeries* series3 = locationStats[i]->p3;
-        series3->setName(locationStats[i]->name);
-        series3->setPen(QPen(locationStats[i]->color, 2));
-        powerChart->addSeries(series3);
-        series3->attachAxis(powerTimeAxis);
-        series3->attachAxis(powerAxisY);
-        powerSeries.append(series3);
-    }
+    // Connect combo box to switch charts
+    connect(seriesSelector, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            chartStackWidget, &QStackedWidget::setCurrentIndex);
 
-    powerChartView = new QChartView(powerChart);
-    powerChartView->setRenderHint(QPainter::Antialiasing);
-    powerChartView->setStyleSheet("background-color: #1e1e1e;");
-
-    // Create voltage chart
-    voltageChart = new QChart();
-    voltageChart->setTitle("Voltage");
-    voltageChart->legend()->hide();
-    voltageChart->setBackgroundBrush(QBrush(QColor("#1e1e1e")));
-    voltageChart->setTitleBrush(QBrush(QColor("white")));
-
-    // Voltage chart time axis
-    voltageTimeAxis = new QDateTimeAxis();
-    voltageTimeAxis->setRange(startTime, endTime);
-    voltageTimeAxis->setFormat("hh:mm:ss");
-    voltageTimeAxis->setTitleText("Time");
-    voltageTimeAxis->setLabelsColor(QColor("white"));
-    voltageTimeAxis->setTitleBrush(QBrush(QColor("white")));
-
-    QValueAxis* voltageAxisY = new QValueAxis();
-    // voltageAxisY->setRange(0, 100);
-    voltageAxisY->setLabelFormat("%d");
-    voltageAxisY->setTitleText("Voltage (V)");
-    voltageAxisY->setLabelsColor(QColor("white"));
-    voltageAxisY->setTitleBrush(QBrush(QColor("white")));
-
-    voltageChart->addAxis(voltageTimeAxis, Qt::AlignBottom);
-    voltageChart->addAxis(voltageAxisY, Qt::AlignLeft);
-
-    // Create series for each location - voltage
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series = locationStats[i]->voltageSeries;
-        series->setName(locationStats[i]->name);
-        series->setPen(QPen(locationStats[i]->color, 2));
-        voltageChart->addSeries(series);
-        series->attachAxis(voltageTimeAxis);
-        series->attachAxis(voltageAxisY);
-        voltageSeries.append(series);
-    }
+    buildingsLayout->addWidget(chartStackWidget, 2);
 
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series1 = locationStats[i]->v1;
-        series1->setName(locationStats[i]->name);
-        series1->setPen(QPen(locationStats[i]->color, 2));
-        voltageChart->addSeries(series1);
-        series1->attachAxis(voltageTimeAxis);
-        series1->attachAxis(voltageAxisY);
-        voltageSeries.append(series1);
-
-        QLineSeries* series2 = locationStats[i]->v2;
-        series2->setName(locationStats[i]->name);
-        series2->setPen(QPen(locationStats[i]->color, 2));
-        voltageChart->addSeries(series2);
-        series2->attachAxis(voltageTimeAxis);
-        series2->attachAxis(voltageAxisY);
-        voltageSeries.append(series2);
-
-        QLineSeries* series3 = locationStats[i]->v3;
-        series3->setName(locationStats[i]->name);
-        series3->setPen(QPen(locationStats[i]->color, 2));
-        voltageChart->addSeries(series3);
-        series3->attachAxis(voltageTimeAxis);
-        series3->attachAxis(voltageAxisY);
-        voltageSeries.append(series3);
-    }
+    // Show what each location's retained history costs
+    connect(MemoryBudget::instance(), &MemoryBudget::usageUpdated, this, &Cluster::updateMemoryUsage);
 
-    voltageChartView = new QChartView(voltageChart);
-    voltageChartView->setRenderHint(QPainter::Antialiasing);
-    voltageChartView->setStyleSheet("background-color: #1e1e1e;");
-
-    // Create current chart
-    currentChart = new QChart();
-    currentChart->setTitle("Current");
-    currentChart->legend()->hide();
-    currentChart->setBackgroundBrush(QBrush(QColor("#1e1e1e")));
-    currentChart->setTitleBrush(QBrush(QColor("white")));
-
-    // Current chart time axis
-    currentTimeAxis = new QDateTimeAxis();
-    // currentTimeAxis->setRange(startTime, endTime);
-    currentTimeAxis->setFormat("hh:mm:ss");
-    currentTimeAxis->setTitleText("Time");
-    currentTimeAxis->setLabelsColor(QColor("white"));
-    currentTimeAxis->setTitleBrush(QBrush(QColor("white")));
-
-    QValueAxis* currentAxisY = new QValueAxis();
-    currentAxisY->setRange(0, 100);
-    currentAxisY->setLabelFormat("%d");
-    currentAxisY->setTitleText("Current (A)");
-    currentAxisY->setLabelsColor(QColor("white"));
-    currentAxisY->setTitleBrush(QBrush(QColor("white")));
-
-    currentChart->addAxis(currentTimeAxis, Qt::AlignBottom);
-    currentChart->addAxis(currentAxisY, Qt::AlignLeft);
-
-    // Create series for each location - current
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series = locationStats[i]->currentSeries;
-        series->setName(locationStats[i]->name);
-        series->setPen(QPen(locationStats[i]->color, 2));
-        currentChart->addSeries(series);
-        series->attachAxis(currentTimeAxis);
-        series->attachAxis(currentAxisY);
-        currentSeries.append(series);
+    // Charts are repainted by the shared frame-capped scheduler, and only the
+    // page currently shown in the stack is ever rendered
+    for (int chart = 0; chart < LocationStats::ChartCount; ++chart) {
+        RenderScheduler::instance()->addTarget(chartView(chart), [this, chart]() { renderChart(chart); });
     }
 
-    for (int i = 0; i < locationStats.size(); ++i) {
-        QLineSeries* series1 = locationStats[i]->c1;
-        series1->setName(locationStats[i]->name);
-        series1->setPen(QPen(locationStats[i]->color, 2));
-        currentChart->addSeries(series1);
-        series1->attachAxis(currentTimeAxis);
-        series1->attachAxis(currentAxisY);
-        currentSeries.append(series1);
-
-        QLineSeries* series2 = locationStats[i]->c2;
-        series2->setName(locationStats[i]->name);
-        series2->setPen(QPen(locationStats[i]->color, 2));
-        currentChart->addSeries(series2);
-        series2->attachAxis(currentTimeAxis);
-        series2->attachAxis(currentAxisY);
-        currentSeries.append(series2);
-
-        QLineSeries* series3 = locationStats[i]->c3;
-        series3->setName(locationStats[i]->name);
-        series3->setPen(QPen(locationStats[i]->color, 2));
-        currentChart->addSeries(series3);
-        series3->attachAxis(currentTimeAxis);
-        series3->attachAxis(currentAxisY);
-        currentSeries.append(series3);
-    }
+    // The overview is repainted on the same clock, with a single dataChanged()
+    // for every row that received samples during the frame
+    RenderScheduler::instance()->addTarget(locationView, [this]() { locationModel->flushChanges(); });
+}
 
-    currentChartView = new QChartView(currentChart);
-    currentChartView->setRenderHint(QPainter::Antialiasing);
-    currentChartView->setStyleSheet("background-color: #1e1e1e;");
+int Cluster::currentLocation() const
+{
+    const QModelIndex index = locationView->currentIndex();
+    return index.isValid() ? index.row() : -1;
+}
 
-    // Add chart views to stack widget
-    chartStackWidget->addWidget(powerChartView);
-    chartStackWidget->addWidget(voltageChartView);
-    chartStackWidget->addWidget(currentChartView);
+void Cluster::onSamplesDelivered() {
+    // A batch was fanned out; only redraw if some of it was ours
+    if (!hasNewSamples) return;
+    hasNewSamples = false;
 
-    // Connect combo box to switch charts
-    connect(seriesSelector, QOverload<int>::of(&QComboBox::currentIndexChanged),
-            chartStackWidget, &QStackedWidget::setCurrentIndex);
+    markViewsDirty();
+}
 
-    buildingsLayout->addWidget(chartStackWidget);
+void Cluster::appendSample(int locationIndex, const PowerSample& sample) {
+    if (storedHistory) {
+        deferredSamples.append(qMakePair(locationIndex, sample));
+        return;
+    }
+
+    LocationStats* location = locationStats[locationIndex];
+    location->appendSample(sample);
+    dataPointCount = qMax(location->dataPointCount, dataPointCount);
+    locationModel->markRowChanged(locationIndex);
+    hasNewSamples = true;
 }
 
-void Cluster::onConnected() {
-    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
-    if (socket) {
-        QString topic = socketToTopic.value(socket);
-        qDebug() << "WebSocket connected to server for topic:" << topic;
+void Cluster::markViewsDirty() {
+    // Rendering happens later, at most once per frame, for the visible chart
+    for (int chart = 0; chart < LocationStats::ChartCount; ++chart) {
+        RenderScheduler::instance()->markDirty(chartView(chart));
     }
+    RenderScheduler::instance()->markDirty(locationView);
 }
 
-void Cluster::onTextMessageReceived(const QString &message) {
-    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
-    if (!socket) return;
+void Cluster::setRetention(qint64 retentionMs) {
+    for (LocationStats* location : locationStats) {
+        location->history.setRetention(retentionMs);
+        location->markAllChartsDirty();
+    }
+    markViewsDirty();
+}
 
-    QString topic = socketToTopic.value(socket);
-    if (topic.isEmpty()) return;
+void Cluster::updateMemoryUsage() {
+    locationModel->updateMemoryUsage();
+}
 
-    qDebug() << "Received on" << topic << ":" << message;
+void Cluster::setChartWindow(qint64 windowMs) {
+    chartWindowMs = windowMs;
 
-    QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8());
-    if (doc.isNull() || !doc.isObject()) {
-        qDebug() << "Error: Invalid JSON message received";
-        return;
+    // Every series has to be rebuilt for the new window
+    for (LocationStats* location : locationStats) {
+        location->markAllChartsDirty();
     }
+    markViewsDirty();
+}
 
-    QJsonObject obj = doc.object();
-
-    if (obj.contains("v1") && obj.contains("v2") && obj.contains("v3") && obj.contains("c1") && obj.contains("c2") && obj.contains("c3") && obj.contains("p1") && obj.contains("p2") && obj.contains("p3")) {
-        double v1 = obj["v1"].toDouble();
-        double v2 = obj["v2"].toDouble();
-        double v3 = obj["v3"].toDouble();
-        double c1 = obj["c1"].toDouble();
-        double c2 = obj["c2"].toDouble();
-        double c3 = obj["c3"].toDouble();
-        double p1 = obj["p1"].toDouble();
-        double p2 = obj["p2"].toDouble();
-        double p3 = obj["p3"].toDouble();
-        double voltage = v3;
-        double current = c3;
-        double power = p3;
-
-        LocationStats* location = topics[topic];
-        QDateTime currentTime = QDateTime::currentDateTime();
-
-        // Store timestamp
-        location->timestamps.append(currentTime);
-        location->dataPointCount++;
-        dataPointCount = qMax(location->dataPointCount, dataPointCount);
+void Cluster::renderChart(int chart) {
+    // Update the time axis first; it decides what the series have to show
+    updateChartRanges(chart);
 
-        // Convert timestamp to msecsSinceEpoch for QLineSeries
-        qint64 timeMs = currentTime.toMSecsSinceEpoch();
-
-        // Add data point with timestamp as x-value
-        location->powerSeries->append(timeMs, power);
-        location->p1->append(timeMs, p1);
-        location->p2->append(timeMs, p2);
-        location->p3->append(timeMs, p3);
-        location->voltageSeries->append(timeMs, voltage);
-        location->v1->append(timeMs, v1);
-        location->v2->append(timeMs, v2);
-        location->v3->append(timeMs, v3);
-        location->currentSeries->append(timeMs, current);
-        location->c1->append(timeMs, c1);
-        location->c2->append(timeMs, c2);
-        location->c3->append(timeMs, c3);
-
-        // Remove oldest points if we exceed MAX_DATA_POINTS
-        if (location->timestamps.size() > location->MAX_DATA_POINTS) {
-            location->powerSeries->remove(0);
-            location->p1->remove(0);
-            location->p2->remove(0);
-            location->p3->remove(0);
-            location->voltageSeries->remove(0);
-            location->v1->remove(0);
-            location->v2->remove(0);
-            location->v3->remove(0);
-            location->currentSeries->remove(0);
-            location->c1->remove(0);
-            location->c2->remove(0);
-            location->c3->remove(0);
-
-            location->timestamps.removeFirst();
+    // About two points per horizontal pixel, whatever the window length
+    const int maxPoints = qMax(2, 2 * int(charts[chart]->plotArea().width()));
+
+    // Feed every location that received data since this chart's last frame
+    for (LocationStats* location : locationStats) {
+        if (location->isChartDirty(chart)) {
+            location->refreshSeries(chart, windowStartMs, windowEndMs, maxPoints);
         }
+    }
 
-        // Update chart ranges
-        updateChartRanges();
+    updateYAxisRanges(chart);
 
-        // Update charts
-        powerChartView->update();
-        voltageChartView->update();
-        currentChartView->update();
-    } else {
-        qDebug() << "Error: Missing voltage/current/power in JSON data";
-    }
+    chartView(chart)->update();
 }
 
-void Cluster::updateChartRanges() {
+void Cluster::updateChartRanges(int chart) {
     // Get the earliest and latest timestamps from all locations
     QDateTime earliestTime;
     QDateTime latestTime;
     bool first = true;
 
     for (LocationStats* location : locationStats) {
-        if (!location->timestamps.isEmpty()) {
-            QDateTime locationEarliest = location->timestamps.first();
-            QDateTime locationLatest = location->timestamps.last();
+        if (!location->isEmpty()) {
+            QDateTime locationEarliest = QDateTime::fromMSecsSinceEpoch(location->firstTimestamp());
+            QDateTime locationLatest = QDateTime::fromMSecsSinceEpoch(location->lastTimestamp());
 
             if (first || locationEarliest < earliestTime) {
                 earliestTime = locationEarliest;
@@ -561,6 +489,9 @@ void Cluster::updateChartRanges() {
 
     // If we have valid timestamps, update the ranges
     if (!first) {
+        // Only the selected window, even when more history is retained
+        earliestTime = qMax(earliestTime, latestTime.addMSecs(-chartWindowMs));
+
         // Add a small buffer at the end for better visibility
         latestTime = latestTime.addSecs(5);
 
@@ -569,94 +500,114 @@ void Cluster::updateChartRanges() {
             earliestTime = latestTime.addSecs(-30);
         }
 
-        // Update all time axes
-        powerTimeAxis->setRange(earliestTime, latestTime);
-        voltageTimeAxis->setRange(earliestTime, latestTime);
-        currentTimeAxis->setRange(earliestTime, latestTime);
-
-        // Also update Y axis ranges based on data
-        updateYAxisRanges();
+        // Update the time axis of the chart being rendered
+        timeAxes[chart]->setRange(earliestTime, latestTime);
+        windowStartMs = earliestTime.toMSecsSinceEpoch();
+        windowEndMs = latestTime.toMSecsSinceEpoch();
     }
 }
 
-void Cluster::updateYAxisRanges() {
-    // Find max values for power, voltage, and current
-    double maxPower = 0;
-    double maxVoltage = 0;
-    double maxCurrent = 0;
+void Cluster::updateYAxisRanges(int chart) {
+    // Extremes of the points each location just pushed to this chart; min/max
+    // decimation keeps every peak, so this matches the raw data in the window
+    double minValue = 0;
+    double maxValue = 0;
 
     for (LocationStats* location : locationStats) {
-        // Check power series
-        const QList<QPointF>& powerPoints = location->powerSeries->points();
-        for (const QPointF& point : powerPoints) {
-            maxPower = qMax(maxPower, point.y());
-        }
+        if (!location->chartHasData[chart])
+            continue;
 
-        // Check voltage series
-        const QList<QPointF>& voltagePoints = location->voltageSeries->points();
-        for (const QPointF& point : voltagePoints) {
-            maxVoltage = qMax(maxVoltage, point.y());
-        }
+        minValue = qMin(minValue, double(location->chartMin[chart]));
+        maxValue = qMax(maxValue, double(location->chartMax[chart]));
+    }
 
-        // Check current series
-        const QList<QPointF>& currentPoints = location->currentSeries->points();
-        for (const QPointF& point : currentPoints) {
-            maxCurrent = qMax(maxCurrent, point.y());
-        }
+    // Snapped to nice numbers with hysteresis; only relayout when it moved
+    NiceAxisRange& range = yAxisRanges[chart];
+    if (range.update(minValue, maxValue)) {
+        QValueAxis* axisY = qobject_cast<QValueAxis*>(chartView(chart)->chart()->axisY());
+        axisY->setRange(range.lower(), range.upper());
     }
+}
 
-    // Add 10% margin to max values
-    maxPower *= 1.1;
-    maxVoltage *= 1.1;
-    maxCurrent *= 1.1;
 
-    // Set minimums
-    maxPower = qMax(100.0, maxPower);
-    maxVoltage = qMax(100.0, maxVoltage);
-    maxCurrent = qMax(100.0, maxCurrent);
+void Cluster::loadStoredHistory() {
+    // Warm restart: refill each location's retention window from the local
+    // store, without holding up the GUI thread however much is stored
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QStringList topicNames;
+    QVector<qint64> fromMs;
+    for (LocationStats* location : locationStats) {
+        topicNames << location->topic;
+        fromMs << now - location->history.retention();
+    }
 
-    // Update axes
-    QValueAxis* powerAxisY = qobject_cast<QValueAxis*>(powerChart->axisY());
-    QValueAxis* voltageAxisY = qobject_cast<QValueAxis*>(voltageChart->axisY());
-    QValueAxis* currentAxisY = qobject_cast<QValueAxis*>(currentChart->axisY());
+    storedHistory = QSharedPointer<StoredHistoryLoader>::create();
+    QThreadPool::globalInstance()->start([loader = storedHistory, topicNames, fromMs, now]() {
+        readStoredHistory(loader, topicNames, fromMs, now);
+    });
 
-    powerAxisY->setRange(0, maxPower);
-    voltageAxisY->setRange(0, maxVoltage);
-    currentAxisY->setRange(0, maxCurrent);
+    storedHistoryTimer = new QTimer(this);
+    storedHistoryTimer->setInterval(STORED_HISTORY_DRAIN_MS);
+    connect(storedHistoryTimer, &QTimer::timeout, this, &Cluster::drainStoredHistory);
+    storedHistoryTimer->start();
 }
 
+void Cluster::drainStoredHistory() {
+    // Read before draining: once done is seen, the queue holds the rest
+    const bool done = storedHistory->done.load(std::memory_order_acquire);
 
-void Cluster::onError(QAbstractSocket::SocketError error) {
-    QWebSocket *socket = qobject_cast<QWebSocket*>(sender());
-    if (socket) {
-        QString topic = socketToTopic.value(socket);
-        qDebug() << "WebSocket error on topic:" << topic;
+    const size_t drained = storedHistory->queue.drain([this](const PowerSample& sample) {
+        const int index = sample.topicId;
+        LocationStats* location = locationStats[index];
+        PowerSample stored = sample;
+        stored.topicId = -1;
+        location->appendSample(stored);
+        dataPointCount = qMax(location->dataPointCount, dataPointCount);
+        locationModel->markRowChanged(index);
+    });
+    if (drained > 0) {
+        markViewsDirty();
     }
-}
 
-void Cluster::connectToWebsockets() {
-    for (const QString& topic : topics.keys()) {
-        QString wsUrl = QString("ws://localhost:8080/ws/%1").arg(topic);
+    if (!done)
+        return;
 
-        QWebSocket *socket = new QWebSocket();
-        connect(socket, &QWebSocket::connected, this, &Cluster::onConnected);
-        connect(socket, &QWebSocket::textMessageReceived, this, &Cluster::onTextMessageReceived);
-        connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QWebSocket::error), this, &Cluster::onError);
+    storedHistoryTimer->deleteLater();
+    storedHistoryTimer = nullptr;
+    storedHistory.reset();
+
+    // Live samples from meanwhile; the store may already have had some
+    const QVector<QPair<int, PowerSample>> deferred = deferredSamples;
+    deferredSamples.clear();
+    for (const QPair<int, PowerSample>& sample : deferred) {
+        const LocationStats* location = locationStats[sample.first];
+        if (location->isEmpty() || sample.second.timestampMs > location->lastTimestamp()) {
+            appendSample(sample.first, sample.second);
+        }
+    }
+    markViewsDirty();
+}
 
-        socketToTopic[socket] = topic;
-        sockets.append(socket);
+void Cluster::connectToWebsockets() {
+    loadStoredHistory();
 
-        LocationStats* location = topics[topic];
-        location->socket = socket;
+    // All clusters share one multiplexed connection per backend; a topic shown
+    // by several clusters is still subscribed and decoded only once
+    ingest = SampleIngest::forBackend();
+    connect(ingest->bus(), &SampleBus::batchPublished, this, &Cluster::onSamplesDelivered);
 
-        socket->open(QUrl(wsUrl));
+    for (int i = 0; i < locationStats.size(); ++i) {
+        LocationStats* location = locationStats[i];
+        location->topicId = ingest->subscribe(location->topic);
+        ingest->bus()->subscribe(location->topicId, this, [this, i](const PowerSample& sample) {
+            appendSample(i, sample);
+        });
     }
 }
 
 void Cluster::updateStats()
 {
-    dataPointCount++;
-    QDateTime currentTime = QDateTime::currentDateTime();
+    qint64 timeMs = QDateTime::currentMSecsSinceEpoch();
 
     // Update location stats with simulated data
     for (int i = 0; i < locationStats.size(); ++i) {
@@ -671,44 +622,31 @@ void Cluster::updateStats()
             currentValue = QRandomGenerator::global()->bounded(50, 80);   // 50-80
         }
 
-        locationLabels[i]->setText(QString("%1 ").arg(locationStats[i]->name));
-
-        // Store timestamp for this data point
-        locationStats[i]->timestamps.append(currentTime);
-
-        // Add data point to chart
-        powerSeries[i]->append(dataPointCount, powerUsage);
-        voltageSeries[i]->append(dataPointCount, voltageValue);
-        currentSeries[i]->append(dataPointCount, currentValue);
-
-        // Remove old data points if we have too many
-        if (powerSeries[i]->count() > MAX_DATA_POINTS) {
-            powerSeries[i]->remove(0);
-            voltageSeries[i]->remove(0);
-            currentSeries[i]->remove(0);
-
-            // Also remove the oldest timestamp
-            if (!locationStats[i]->timestamps.isEmpty()) {
-                locationStats[i]->timestamps.removeFirst();
-            }
+        // Same path as live data, every phase gets the simulated value
+        const float simulated[ChannelSchema::QuantityCount] = {
+            float(voltageValue), float(currentValue), float(powerUsage)
+        };
+        PowerSample sample;
+        sample.timestampMs = timeMs;
+        sample.topicId = locationStats[i]->topicId;
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            sample.values[channel] = simulated[ChannelSchema::Channels[channel].quantity];
         }
+        appendSample(i, sample);
     }
 
-    // Update chart time ranges
-    updateChartRanges();
-
-    // Update chart views
-    powerChartView->update();
-    voltageChartView->update();
-    currentChartView->update();
+    markViewsDirty();
 }
 
 void Cluster::showLocationDetails(int locationIndex)
 {
+    if (locationIndex < 0 || locationIndex >= locationStats.size())
+        return;
+
     LocationStats* location = locationStats[locationIndex];
 
     // Create and show the ModernGaugeDialog
-    LocationDetailDialog* dialog = new LocationDetailDialog(location->name, location->topic, location->socket);
+    LocationDetailDialog* dialog = new LocationDetailDialog(location->name, location->topic, ingest);
 
     // Set the dialog title to include location name
     dialog->setWindowTitle(QString("Power Monitoring - %1").arg(location->name));
@@ -757,6 +695,9 @@ void MainWindow::setupUI()
     // Set the scroll widget to the scroll area
     scrollArea->setWidget(scrollWidget);
 
+    // Clusters scrolled out of view skip chart work; catch up when they return
+    RenderScheduler::instance()->watchScrolling(scrollArea);
+
     // Add the scroll area to the main layout
     mainLayout->addWidget(scrollArea);
 
@@ -23,6 +23,8 @@
 #include <QComboBox>
 #include <QtWebSockets/QWebSocket>
 #include <QMap>
+#include <QPair>
+#include <QSharedPointer>
 #include <QString>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -30,10 +32,18 @@
 #include <QTextEdit>
 #include <QDateTime>
 #include <QToolTip>
+#include <QTableView>
 #include "LocationDetailDialog.h"
 #include "ModernGaugeWidget.h"
 #include "ScheduleManagerDialog.h"
 #include "datarecorddialog.h"
+#include "SampleIngest.h"
+#include "LocationHistory.h"
+#include "MemoryBudget.h"
+#include "RenderScheduler.h"
+#include "NiceAxisRange.h"
+#include "LocationTableModel.h"
+#include "LocationOverviewDelegate.h"
 //QT_CHARTS_USE_NAMESPACE
 class LocationStats : public QObject {
     Q_OBJECT
@@ -41,82 +51,110 @@ public:
     QString name;
     QColor color;
     QString topic;
-    QWebSocket* socket;
+    int topicId = -1;
     int dataPointCount = 0;
-    const int MAX_DATA_POINTS = 100;
-    QLineSeries* powerSeries;
-    QLineSeries* p1;
-    QLineSeries* p2;
-    QLineSeries* p3;
-    QLineSeries* v1;
-    QLineSeries* v2;
-    QLineSeries* v3;
-    QLineSeries* c1;
-    QLineSeries* c2;
-    QLineSeries* c3;
-    QLineSeries* voltageSeries;
-    QLineSeries* currentSeries;
-    QList<QDateTime> timestamps;
+    // Charts in the order of the cluster's chart stack, see
+    // ChannelSchema::ChartQuantities
+    static constexpr int ChartCount = ChannelSchema::ChartCount;
+
+    // One series per schema channel, plus one aggregate series per chart
+    QLineSeries* channelSeries[ChannelSchema::ChannelCount];
+    QLineSeries* aggregateSeries[ChartCount];
+
+    // Time-bounded history; the series above are only views refreshed from it
+    LocationHistory history;
+    // Newest sample, for the live values of the overview
+    PowerSample lastSample;
+    // One bit per chart whose series lag behind the history
+    int dirtyCharts = 0;
+    // Extremes of what each chart's series currently show
+    float chartMin[ChartCount] = {};
+    float chartMax[ChartCount] = {};
+    bool chartHasData[ChartCount] = {};
 
     LocationStats(QString name, QColor color, QString topic)
-        : name(name), color(color), topic(topic)
+        : name(name), color(color), topic(topic), history(name)
     {
-        powerSeries = new QLineSeries();
-        p1 = new QLineSeries();
-        p2 = new QLineSeries();
-        p3 = new QLineSeries();
+        // Setup hover handlers for tooltip display
+        for (int channel = 0; channel < ChannelSchema::ChannelCount; ++channel) {
+            const ChannelSchema::ChannelInfo& info = ChannelSchema::Channels[channel];
+            channelSeries[channel] = new QLineSeries();
+            setupSeriesHover(channelSeries[channel], QString("%1%2")
+                                 .arg(ChannelSchema::Quantities[info.quantity].name)
+                                 .arg(info.phase + 1));
+        }
 
-        voltageSeries = new QLineSeries();
-        v1 = new QLineSeries();
-        v2 = new QLineSeries();
-        v3 = new QLineSeries();
+        for (int chart = 0; chart < ChartCount; ++chart) {
+            aggregateSeries[chart] = new QLineSeries();
+            setupSeriesHover(aggregateSeries[chart],
+                             ChannelSchema::Quantities[ChannelSchema::ChartQuantities[chart]].name);
+        }
+    }
 
-        currentSeries = new QLineSeries();
-        c1 = new QLineSeries();
-        c2 = new QLineSeries();
-        c3 = new QLineSeries();
+    QVector<ScheduleManagerDialog::Schedule> schedules;
 
-        // Setup hover handlers for tooltip display
-        setupSeriesHover(p1, "Power1");
-        setupSeriesHover(p2, "Power2");
-        setupSeriesHover(p3, "Power3");
-        setupSeriesHover(powerSeries, "Power");
-        setupSeriesHover(voltageSeries, "Voltage");
-        setupSeriesHover(currentSeries, "Current");
+    void appendSample(const PowerSample& sample) {
+        history.append(sample);
+        lastSample = sample;
+        dataPointCount++;
+        dirtyCharts = (1 << ChartCount) - 1;
     }
 
-    QVector<ScheduleManagerDialog::Schedule> schedules;
+    bool isChartDirty(int chart) const { return dirtyCharts & (1 << chart); }
+    void markAllChartsDirty() { dirtyCharts = (1 << ChartCount) - 1; }
 
-    void addDataPoint(double power, double voltage, double current) {
-        QDateTime currentTime = QDateTime::currentDateTime();
-        timestamps.append(currentTime);
+    bool isEmpty() const { return history.isEmpty(); }
+    qint64 firstTimestamp() const { return history.firstTimestamp(); }
+    qint64 lastTimestamp() const { return history.lastTimestamp(); }
 
-        dataPointCount++;
-        qint64 timeMs = currentTime.toMSecsSinceEpoch();
+    // Push the window [fromMs, toMs] of one chart to its series, with a single
+    // replace() per series and at most about maxPoints points each, however
+    // long the window is
+    void refreshSeries(int chart, qint64 fromMs, qint64 toMs, int maxPoints) {
+        const ChannelSchema::Quantity quantity = ChannelSchema::ChartQuantities[chart];
+        const int first = ChannelSchema::firstChannel(quantity);
+        const int last = first + ChannelSchema::channelCount(quantity);
 
-        powerSeries->append(timeMs, power);
-        voltageSeries->append(timeMs, voltage);
-        currentSeries->append(timeMs, current);
+        chartHasData[chart] = false;
+        for (int channel = first; channel < last; ++channel) {
+            history.windowPoints(channel, fromMs, toMs, maxPoints, pointBuffer);
+            channelSeries[channel]->replace(pointBuffer);
+            // The aggregate shares the last channel's points already in the buffer
+            if (channel == ChannelSchema::aggregateChannel(quantity)) {
+                aggregateSeries[chart]->replace(pointBuffer);
+            }
+
+            for (const QPointF& point : pointBuffer) {
+                if (!chartHasData[chart]) {
+                    chartMin[chart] = chartMax[chart] = point.y();
+                    chartHasData[chart] = true;
+                }
+                chartMin[chart] = qMin(chartMin[chart], float(point.y()));
+                chartMax[chart] = qMax(chartMax[chart], float(point.y()));
+            }
+        }
+        dirtyCharts &= ~(1 << chart);
     }
 
 
 
 
 private:
+    // Scratch buffer reused by refreshSeries() so refreshes don't reallocate
+    QList<QPointF> pointBuffer;
+
     void setupSeriesHover(QLineSeries* series, const QString& seriesType) {
-        connect(series, &QLineSeries::hovered, [this, series, seriesType](const QPointF &point, bool state) {
+        connect(series, &QLineSeries::hovered, [this, seriesType](const QPointF &point, bool state) {
             if (state) {
-                int index = qRound(point.x()) - 1;
-                if (index >= 0 && index < timestamps.size()) {
-                    double value = point.y();
-                    QString timeStr = timestamps[index].toString("yyyy-MM-dd hh:mm:ss");
-                    QString tooltipText = QString("%1\n%2: %3\nTime: %4")
-                                              .arg(name)
-                                              .arg(seriesType)
-                                              .arg(value)
-                                              .arg(timeStr);
-                    QToolTip::showText(QCursor::pos(), tooltipText);
-                }
+                // x-values are msecs since epoch
+                double value = point.y();
+                QString timeStr = QDateTime::fromMSecsSinceEpoch(qint64(point.x())).toString("yyyy-MM-dd hh:mm:ss");
+                QString tooltipText = QString("%1\n%2: %3\nTime: %4")
+                                          .arg(name)
+                                          .arg(seriesType)
+                                          .arg(value)
+                                          .arg(timeStr);
+                QToolTip::showText(QCursor::pos(), tooltipText);
             }
         });
     }
@@ -124,6 +162,8 @@ private:
 
 };
 
+struct StoredHistoryLoader;
+
 class Cluster : public QMainWindow
 {
     Q_OBJECT
@@ -131,13 +171,15 @@ public:
     explicit Cluster(QWidget *parent = nullptr);
     ~Cluster();
     void setupClusterUI();
+    // Time window retained by every location of this cluster
+    void setRetention(qint64 retentionMs);
 private slots:
     void updateStats();
     void showLocationDetails(int locationIndex);
-    void onConnected();
-    void onTextMessageReceived(const QString &message);
-    void onError(QAbstractSocket::SocketError error);
-    void updateChartRanges();
+    void onSamplesDelivered();
+    void updateChartRanges(int chart);
+    void setChartWindow(qint64 windowMs);
+    void updateMemoryUsage();
 
 public slots:
     void showDataRecorder(int locationIndex);
@@ -147,30 +189,42 @@ public slots:
 
 private:
     QMap<QString, LocationStats*> topics;
-    QMap<QWebSocket*, QString> socketToTopic;
-    QList<QWebSocket*> sockets;
+    // Shared per-backend subscription manager
+    SampleIngest* ingest;
+    bool hasNewSamples = false;
     void connectToWebsockets();
+    void loadStoredHistory();
+    void drainStoredHistory();
+    void appendSample(int locationIndex, const PowerSample& sample);
+    // Warm restart: the retention window is read from the local store on the
+    // global pool and drained from its queue here a batch per tick. Live
+    // samples wait until it is all in, so history stays in time order.
+    QSharedPointer<StoredHistoryLoader> storedHistory;
+    QTimer* storedHistoryTimer = nullptr;
+    QVector<QPair<int, PowerSample>> deferredSamples;
+    // Charts and overview are rendered later, at most once per frame
+    void markViewsDirty();
+    void renderChart(int chart);
+    QChartView* chartView(int chart) const { return chartViews[chart]; }
     void createBuildingsSection();
+    // Row selected in the overview, or -1
+    int currentLocation() const;
     QWidget* centralWidget;
     QVBoxLayout* mainLayout;
     // Buildings section
     QWidget* buildingsWidget;
     QVBoxLayout* buildingsLayout;
-    // Charts and chart views
-    QChart* powerChart;
-    QChartView* powerChartView;
-    QChart* voltageChart;
-    QChartView* voltageChartView;
-    QChart* currentChart;
-    QChartView* currentChartView;
+    // Charts and chart views, indexed like ChannelSchema::ChartQuantities
+    QChart* charts[LocationStats::ChartCount];
+    QChartView* chartViews[LocationStats::ChartCount];
     QStackedWidget* chartStackWidget;
     QVector<LocationStats*> locationStats;
-    QVector<QLabel*> locationLabels;
+    // Overview of all locations; only the rows on screen are ever painted
+    LocationTableModel* locationModel;
+    QTableView* locationView;
     QVector<LocationDetailDialog*> locationDialogs;
-    // Series for different measurements
-    QVector<QLineSeries*> powerSeries;
-    QVector<QLineSeries*> voltageSeries;
-    QVector<QLineSeries*> currentSeries;
+    // Series of all charts
+    QVector<QLineSeries*> chartSeries;
     // Power section
     QWidget* powerWidget;
     QGridLayout* powerLayout;
@@ -187,15 +241,19 @@ private:
     QProcess* systemInfoProcess;
     // Data for simulating system stats
     int dataPointCount;
-    const int MAX_DATA_POINTS = 100;
+
+    // Length of the time window shown by the charts, and the window last set
+    // on the time axes
+    qint64 chartWindowMs = 2 * 60 * 1000;
+    qint64 windowStartMs = 0;
+    qint64 windowEndMs = 0;
 
     // Time-axis related members
-    QDateTimeAxis* powerTimeAxis;
-    QDateTimeAxis* voltageTimeAxis;
-    QDateTimeAxis* currentTimeAxis;
+    QDateTimeAxis* timeAxes[LocationStats::ChartCount];
 
     // Update y-axis ranges based on current data
-    void updateYAxisRanges();
+    void updateYAxisRanges(int chart);
+    QVector<NiceAxisRange> yAxisRanges;
 
     // for schedule manager
     QVector<QVector<ScheduleManagerDialog::Schedule>> locationSchedules;
@@ -1,21 +1,70 @@
-QT       += core gui charts websockets printsupport
+QT       += core gui charts websockets printsupport concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
-CONFIG += c++11
+CONFIG += c++17
 
 SOURCES += \
+    ApiClient.cpp \
+    BucketColumns.cpp \
+    CsvExporter.cpp \
+    GaugeAnimator.cpp \
+    GorillaBlock.cpp \
+    HistoryChart.cpp \
     LocationDetailDialog.cpp \
+    LocationHistory.cpp \
+    LocationOverviewDelegate.cpp \
+    LocationTableModel.cpp \
+    LodPyramid.cpp \
+    MemoryBudget.cpp \
     ModernGaugeWidget.cpp \
+    SampleBus.cpp \
+    NiceAxisRange.cpp \
+    PdfReportEngine.cpp \
+    RecordArchive.cpp \
+    RecordCache.cpp \
+    RecordColumns.cpp \
+    RecordStreamParser.cpp \
+    RecordTableModel.cpp \
+    RenderScheduler.cpp \
+    SampleIngest.cpp \
+    SampleRingBuffer.cpp \
+    SampleStore.cpp \
     ScheduleManagerDialog.cpp \
     datarecorddialog.cpp \
     main.cpp \
     mainwindow.cpp\
 
 HEADERS += \
+    ChannelSchema.h \
+    ApiClient.h \
+    BucketColumns.h \
+    CsvExporter.h \
+    GaugeAnimator.h \
+    GorillaBlock.h \
+    HistoryChart.h \
     LocationDetailDialog.h \
+    LocationHistory.h \
+    LocationOverviewDelegate.h \
+    LocationTableModel.h \
+    LodPyramid.h \
+    MemoryBudget.h \
     ModernGaugeWidget.h \
+    NiceAxisRange.h \
+    PdfReportEngine.h \
+    PowerSample.h \
+    RecordArchive.h \
+    RecordCache.h \
+    RecordColumns.h \
+    RecordStreamParser.h \
+    RecordTableModel.h \
+    RenderScheduler.h \
+    SampleBus.h \
+    SampleIngest.h \
+    SampleRingBuffer.h \
+    SampleStore.h \
     ScheduleManagerDialog.h \
+    SpscQueue.h \
     datarecorddialog.h \
     mainwindow.h\
 